@@ -0,0 +1,664 @@
+// Copyright(c) 2022 Sebastian Veith
+
+#include "pch.h"
+
+#include "stub_runtime.h"
+#include "tests.h"
+#include <layer.h>
+#include <tracker.h>
+#include <dispatch.h>
+#include <log.h>
+#include <util.h>
+#include <evntrace.h>
+
+using namespace motion_compensation_layer;
+using namespace xr::math;
+
+namespace
+{
+    std::atomic<uint64_t> g_Allocations{0};
+    std::atomic<uint64_t> g_AllocatedBytes{0};
+    // allocations of the calling thread only, unaffected by background threads of the layer
+    thread_local uint64_t t_Allocations{0};
+
+    // rig stays at rest until motion starts after activation
+    std::atomic<XrTime> g_MotionStart{std::numeric_limits<XrTime>::max()};
+} // namespace
+
+// count heap allocations of the layer, the stub runtime and the frame loop don't allocate on their own
+void* operator new(size_t size)
+{
+    g_Allocations++;
+    g_AllocatedBytes += size;
+    t_Allocations++;
+    if (void* memory = malloc(size ? size : 1))
+    {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* memory) noexcept
+{
+    free(memory);
+}
+
+void operator delete(void* memory, size_t size) noexcept
+{
+    free(memory);
+}
+
+namespace
+{
+    constexpr int FrameCount{10000};
+    constexpr float PositionTolerance{0.0001f}; // 0.1 mm
+    constexpr float AngleTolerance{0.01f};      // degree
+    const std::string Application{"LayerBenchmark"};
+    const std::string InputScript{"benchmark_input.txt"};
+    const std::chrono::seconds ActivationTimeout{5};
+    constexpr int TraceCount{100000};
+    // runtime functions called within a frame, by the application or the layer
+    constexpr std::array<const char*, 7> FrameFunctions{"xrWaitFrame",
+                                                        "xrBeginFrame",
+                                                        "xrSyncActions",
+                                                        "xrGetActionStatePose",
+                                                        "xrLocateSpace",
+                                                        "xrLocateViews",
+                                                        "xrEndFrame"};
+    // {40633bc2-ca4a-4c13-88b6-7a55ed74e061}, same as the trace provider of the layer
+    constexpr GUID TraceProviderGuid{0x40633bc2, 0xca4a, 0x4c13, {0x88, 0xb6, 0x7a, 0x55, 0xed, 0x74, 0xe0, 0x61}};
+    constexpr wchar_t TraceSessionName[]{L"OXRMC_LayerTests"};
+
+    // entry points used by the simulated application
+    struct Functions
+    {
+        PFN_xrDestroyInstance xrDestroyInstance{nullptr};
+        PFN_xrGetSystem xrGetSystem{nullptr};
+        PFN_xrCreateSession xrCreateSession{nullptr};
+        PFN_xrDestroySession xrDestroySession{nullptr};
+        PFN_xrBeginSession xrBeginSession{nullptr};
+        PFN_xrEndSession xrEndSession{nullptr};
+        PFN_xrCreateReferenceSpace xrCreateReferenceSpace{nullptr};
+        PFN_xrLocateSpace xrLocateSpace{nullptr};
+        PFN_xrLocateViews xrLocateViews{nullptr};
+        PFN_xrSyncActions xrSyncActions{nullptr};
+        PFN_xrWaitFrame xrWaitFrame{nullptr};
+        PFN_xrBeginFrame xrBeginFrame{nullptr};
+        PFN_xrEndFrame xrEndFrame{nullptr};
+    };
+
+    struct Result
+    {
+        std::vector<double> durations;
+        uint64_t allocations{0};
+        uint64_t allocatedBytes{0};
+        // on the application thread
+        uint64_t frameAllocations{0};
+        uint64_t endFrameAllocations{0};
+        // of the stub runtime, from any thread
+        uint64_t runtimeCalls{0};
+        std::array<uint64_t, FrameFunctions.size()> functionCalls{};
+        float viewPositionError{0.0f};
+        float viewAngleError{0.0f};
+        float submitPositionError{0.0f};
+        float submitAngleError{0.0f};
+    };
+
+    template <typename T>
+    bool Resolve(PFN_xrGetInstanceProcAddr getInstanceProcAddr, XrInstance instance, const char* name, T& function)
+    {
+        if (XR_FAILED(getInstanceProcAddr(instance, name, reinterpret_cast<PFN_xrVoidFunction*>(&function))))
+        {
+            std::cout << "unable to resolve " << name << "\n";
+            return false;
+        }
+        return true;
+    }
+
+    bool ResolveFunctions(PFN_xrGetInstanceProcAddr getInstanceProcAddr, XrInstance instance, Functions& xr)
+    {
+        // the layer only resolves the next function pointers when the application requests them, like the loader
+        // does for every function the application uses
+        for (const char* name : {"xrCreateActionSpace",
+                                 "xrDestroySpace",
+                                 "xrSuggestInteractionProfileBindings",
+                                 "xrAttachSessionActionSets",
+                                 "xrGetCurrentInteractionProfile",
+                                 "xrCreateSwapchain",
+                                 "xrDestroySwapchain",
+                                 "xrAcquireSwapchainImage",
+                                 "xrWaitSwapchainImage",
+                                 "xrReleaseSwapchainImage"})
+        {
+            PFN_xrVoidFunction function;
+            if (!Resolve(getInstanceProcAddr, instance, name, function))
+            {
+                return false;
+            }
+        }
+        return Resolve(getInstanceProcAddr, instance, "xrDestroyInstance", xr.xrDestroyInstance) &&
+               Resolve(getInstanceProcAddr, instance, "xrGetSystem", xr.xrGetSystem) &&
+               Resolve(getInstanceProcAddr, instance, "xrCreateSession", xr.xrCreateSession) &&
+               Resolve(getInstanceProcAddr, instance, "xrDestroySession", xr.xrDestroySession) &&
+               Resolve(getInstanceProcAddr, instance, "xrBeginSession", xr.xrBeginSession) &&
+               Resolve(getInstanceProcAddr, instance, "xrEndSession", xr.xrEndSession) &&
+               Resolve(getInstanceProcAddr, instance, "xrCreateReferenceSpace", xr.xrCreateReferenceSpace) &&
+               Resolve(getInstanceProcAddr, instance, "xrLocateSpace", xr.xrLocateSpace) &&
+               Resolve(getInstanceProcAddr, instance, "xrLocateViews", xr.xrLocateViews) &&
+               Resolve(getInstanceProcAddr, instance, "xrSyncActions", xr.xrSyncActions) &&
+               Resolve(getInstanceProcAddr, instance, "xrWaitFrame", xr.xrWaitFrame) &&
+               Resolve(getInstanceProcAddr, instance, "xrBeginFrame", xr.xrBeginFrame) &&
+               Resolve(getInstanceProcAddr, instance, "xrEndFrame", xr.xrEndFrame);
+    }
+
+    XrPosef Rotation(float yaw, float pitch, float roll)
+    {
+        XrPosef pose{Pose::Identity()};
+        StoreXrQuaternion(&pose.orientation,
+                          DirectX::XMQuaternionRotationRollPitchYaw(pitch * Tracker::angleToRadian,
+                                                                    yaw * Tracker::angleToRadian,
+                                                                    roll * Tracker::angleToRadian));
+        return pose;
+    }
+
+    float Wave(XrTime time, double period, double phase)
+    {
+        return (float)sin(DirectX::XM_2PI * ((double)time / 1000000000.0 / period + phase));
+    }
+
+    void UpdateError(const XrPosef& pose, const XrPosef& expected, float& positionError, float& angleError)
+    {
+        const float dx = pose.position.x - expected.position.x;
+        const float dy = pose.position.y - expected.position.y;
+        const float dz = pose.position.z - expected.position.z;
+        const float dot = pose.orientation.x * expected.orientation.x + pose.orientation.y * expected.orientation.y +
+                          pose.orientation.z * expected.orientation.z + pose.orientation.w * expected.orientation.w;
+        positionError = std::max(positionError, sqrt(dx * dx + dy * dy + dz * dz));
+        angleError = std::max(angleError, 2.0f * acos(std::min(1.0f, fabs(dot))) / Tracker::angleToRadian);
+    }
+
+    // a frame of a typical application: input, head pose for the game logic, eye poses for rendering and submission
+    bool RunFrame(const Functions& xr, XrSession session, XrSpace localSpace, XrSpace viewSpace, Result* result)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        const uint64_t frameAllocations = t_Allocations;
+
+        XrFrameState frameState{XR_TYPE_FRAME_STATE};
+        XrFrameWaitInfo frameWaitInfo{XR_TYPE_FRAME_WAIT_INFO};
+        if (XR_FAILED(xr.xrWaitFrame(session, &frameWaitInfo, &frameState)))
+        {
+            return false;
+        }
+        const XrTime time = frameState.predictedDisplayTime;
+        XrFrameBeginInfo frameBeginInfo{XR_TYPE_FRAME_BEGIN_INFO};
+        if (XR_FAILED(xr.xrBeginFrame(session, &frameBeginInfo)))
+        {
+            return false;
+        }
+
+        // the application has no action sets of its own, the layer adds the tracker action set
+        XrActionsSyncInfo syncInfo{XR_TYPE_ACTIONS_SYNC_INFO};
+        if (XR_FAILED(xr.xrSyncActions(session, &syncInfo)))
+        {
+            return false;
+        }
+
+        XrSpaceLocation location{XR_TYPE_SPACE_LOCATION};
+        if (XR_FAILED(xr.xrLocateSpace(viewSpace, localSpace, time, &location)))
+        {
+            return false;
+        }
+
+        XrViewLocateInfo viewLocateInfo{XR_TYPE_VIEW_LOCATE_INFO,
+                                        nullptr,
+                                        XR_VIEW_CONFIGURATION_TYPE_PRIMARY_STEREO,
+                                        time,
+                                        localSpace};
+        XrViewState viewState{XR_TYPE_VIEW_STATE};
+        std::array<XrView, StubRuntime::ViewCount> views{{{XR_TYPE_VIEW}, {XR_TYPE_VIEW}}};
+        uint32_t viewCount{0};
+        if (XR_FAILED(xr.xrLocateViews(session,
+                                       &viewLocateInfo,
+                                       &viewState,
+                                       (uint32_t)views.size(),
+                                       &viewCount,
+                                       views.data())))
+        {
+            return false;
+        }
+
+        std::array<XrCompositionLayerProjectionView, StubRuntime::ViewCount> projectionViews{};
+        for (uint32_t i = 0; i < viewCount; i++)
+        {
+            projectionViews[i] = {XR_TYPE_COMPOSITION_LAYER_PROJECTION_VIEW, nullptr, views[i].pose, views[i].fov};
+        }
+        XrCompositionLayerProjection projectionLayer{XR_TYPE_COMPOSITION_LAYER_PROJECTION,
+                                                     nullptr,
+                                                     0,
+                                                     localSpace,
+                                                     viewCount,
+                                                     projectionViews.data()};
+        const XrCompositionLayerBaseHeader* layers[]{
+            reinterpret_cast<const XrCompositionLayerBaseHeader*>(&projectionLayer)};
+        XrFrameEndInfo frameEndInfo{XR_TYPE_FRAME_END_INFO,
+                                    nullptr,
+                                    time,
+                                    XR_ENVIRONMENT_BLEND_MODE_OPAQUE,
+                                    1,
+                                    layers};
+        const uint64_t endFrameAllocations = t_Allocations;
+        if (XR_FAILED(xr.xrEndFrame(session, &frameEndInfo)))
+        {
+            return false;
+        }
+
+        if (result)
+        {
+            result->durations.push_back(
+                std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count());
+            result->endFrameAllocations += t_Allocations - endFrameAllocations;
+            result->frameAllocations += t_Allocations - frameAllocations;
+
+            // the application sees the head moving on the rig only, the runtime gets back what it rendered
+            UpdateError(location.pose,
+                        StubRuntime::GetHeadPoseOnRig(time),
+                        result->viewPositionError,
+                        result->viewAngleError);
+            const StubRuntime::Submission& submission = StubRuntime::GetLastSubmission();
+            for (uint32_t i = 0; i < viewCount; i++)
+            {
+                UpdateError(views[i].pose,
+                            StubRuntime::GetEyePoseOnRig(i, time),
+                            result->viewPositionError,
+                            result->viewAngleError);
+                UpdateError(submission.poses[i],
+                            StubRuntime::GetEyePose(i, time),
+                            result->submitPositionError,
+                            result->submitAngleError);
+            }
+        }
+        return true;
+    }
+
+    bool RunFrames(const Functions& xr, XrSession session, XrSpace localSpace, XrSpace viewSpace, Result& result)
+    {
+        result.durations.reserve(FrameCount);
+        const uint64_t allocations = g_Allocations, allocatedBytes = g_AllocatedBytes;
+        const uint64_t runtimeCalls = StubRuntime::GetCalls();
+        std::array<uint64_t, FrameFunctions.size()> functionCalls{};
+        for (size_t i = 0; i < FrameFunctions.size(); i++)
+        {
+            functionCalls[i] = StubRuntime::GetCalls(FrameFunctions[i]);
+        }
+        for (int frame = 0; frame < FrameCount; frame++)
+        {
+            if (!RunFrame(xr, session, localSpace, viewSpace, &result))
+            {
+                std::cout << "frame " << frame << " failed\n";
+                return false;
+            }
+        }
+        result.allocations = g_Allocations - allocations;
+        result.allocatedBytes = g_AllocatedBytes - allocatedBytes;
+        result.runtimeCalls = StubRuntime::GetCalls() - runtimeCalls;
+        for (size_t i = 0; i < FrameFunctions.size(); i++)
+        {
+            result.functionCalls[i] = StubRuntime::GetCalls(FrameFunctions[i]) - functionCalls[i];
+        }
+        return true;
+    }
+
+    // in-memory etw session enabling the trace provider of the layer, starting it requires administrator rights
+    class TraceSession
+    {
+      public:
+        ~TraceSession()
+        {
+            Stop();
+        }
+
+        bool Start()
+        {
+            // remove a session left over by an aborted run
+            ControlTraceW(0, TraceSessionName, Properties(), EVENT_TRACE_CONTROL_STOP);
+            ULONG error = StartTraceW(&m_Handle, TraceSessionName, Properties());
+            if (ERROR_SUCCESS != error)
+            {
+                std::cout << "unable to start trace session, error = " << error << "\n";
+                m_Handle = 0;
+                return false;
+            }
+            error = EnableTraceEx2(m_Handle,
+                                   &TraceProviderGuid,
+                                   EVENT_CONTROL_CODE_ENABLE_PROVIDER,
+                                   TRACE_LEVEL_VERBOSE,
+                                   0,
+                                   0,
+                                   1000,
+                                   nullptr);
+            if (ERROR_SUCCESS != error)
+            {
+                std::cout << "unable to enable trace provider, error = " << error << "\n";
+                Stop();
+                return false;
+            }
+            return true;
+        }
+
+        void Stop()
+        {
+            if (m_Handle)
+            {
+                ControlTraceW(m_Handle, nullptr, Properties(), EVENT_TRACE_CONTROL_STOP);
+                m_Handle = 0;
+            }
+        }
+
+      private:
+        EVENT_TRACE_PROPERTIES* Properties()
+        {
+            m_Properties.assign(sizeof(EVENT_TRACE_PROPERTIES) + sizeof(TraceSessionName), 0);
+            auto* properties = reinterpret_cast<EVENT_TRACE_PROPERTIES*>(m_Properties.data());
+            properties->Wnode.BufferSize = (ULONG)m_Properties.size();
+            properties->Wnode.Flags = WNODE_FLAG_TRACED_GUID;
+            properties->Wnode.ClientContext = 1; // query performance counter
+            properties->LogFileMode = EVENT_TRACE_BUFFERING_MODE;
+            properties->LoggerNameOffset = sizeof(EVENT_TRACE_PROPERTIES);
+            return properties;
+        }
+
+        TRACEHANDLE m_Handle{0};
+        std::vector<char> m_Properties;
+    };
+
+    struct TraceResult
+    {
+        // per trace call
+        double rawTime{0.0};
+        double formattedTime{0.0};
+        double rawAllocations{0.0};
+        double formattedAllocations{0.0};
+    };
+
+    // pose traced as raw fields (TLXrPose) compared to the formatted string used before
+    TraceResult MeasureTracing()
+    {
+        XrPosef pose = Rotation(10.0f, 5.0f, 3.0f);
+        pose.position = {0.1f, 0.8f, -0.2f};
+        TraceResult result;
+
+        uint64_t allocations = t_Allocations;
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < TraceCount; i++)
+        {
+            pose.position.x = (float)i;
+            TraceLoggingWrite(log::g_traceProvider, "Benchmark_Pose", TLXrPose(pose, "Pose"));
+        }
+        result.rawTime =
+            std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / TraceCount;
+        result.rawAllocations = (double)(t_Allocations - allocations) / TraceCount;
+
+        allocations = t_Allocations;
+        start = std::chrono::steady_clock::now();
+        for (int i = 0; i < TraceCount; i++)
+        {
+            pose.position.x = (float)i;
+            TraceLoggingWrite(log::g_traceProvider, "Benchmark_Pose", TLArg(xr::ToString(pose).c_str(), "Pose"));
+        }
+        result.formattedTime =
+            std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / TraceCount;
+        result.formattedAllocations = (double)(t_Allocations - allocations) / TraceCount;
+        return result;
+    }
+
+    void PrintTraceResult(const std::string& label, const TraceResult& result)
+    {
+        std::cout << fmt::format("{:<14}{:>10.1f}{:>14.2f}{:>12.1f}{:>14.2f}\n",
+                                 label,
+                                 result.rawTime,
+                                 result.rawAllocations,
+                                 result.formattedTime,
+                                 result.formattedAllocations);
+    }
+
+    void PrintResult(const std::string& label, Result& result)
+    {
+        std::sort(result.durations.begin(), result.durations.end());
+        double mean{0.0};
+        for (const double duration : result.durations)
+        {
+            mean += duration;
+        }
+        mean /= result.durations.size();
+        const auto percentile = [&result](double p) {
+            return result.durations[std::min(result.durations.size() - 1, (size_t)(p * result.durations.size()))];
+        };
+        std::cout << fmt::format("{:<10}{:>10.2f}{:>10.2f}{:>10.2f}{:>10.2f}{:>14.3f}{:>12.1f}{:>16.2f}\n",
+                                 label,
+                                 mean,
+                                 percentile(0.5),
+                                 percentile(0.99),
+                                 result.durations.back(),
+                                 (double)result.allocations / result.durations.size(),
+                                 (double)result.allocatedBytes / result.durations.size(),
+                                 (double)result.runtimeCalls / result.durations.size());
+    }
+
+    double GetCallsPerFrame(const Result& result, const std::string& function)
+    {
+        const auto entry = std::find(FrameFunctions.cbegin(), FrameFunctions.cend(), function);
+        return FrameFunctions.cend() != entry
+                   ? (double)result.functionCalls[entry - FrameFunctions.cbegin()] / result.durations.size()
+                   : 0.0;
+    }
+
+    void PrintFunctionCalls(const Result& withLayer, const Result& withoutLayer)
+    {
+        std::cout << fmt::format("{:<24}{:>10}{:>10}\n", "runtime calls per frame", "layer", "runtime");
+        for (size_t i = 0; i < FrameFunctions.size(); i++)
+        {
+            std::cout << fmt::format("{:<24}{:>10.2f}{:>10.2f}\n",
+                                     FrameFunctions[i],
+                                     GetCallsPerFrame(withLayer, FrameFunctions[i]),
+                                     GetCallsPerFrame(withoutLayer, FrameFunctions[i]));
+        }
+    }
+} // namespace
+
+namespace Tests
+{
+    bool Benchmark()
+    {
+        // unfiltered controller tracking allows exact reconstruction, activation is triggered by input script
+        if (!InitConfig(Application,
+                        {{"tracker", "type", "controller"},
+                         {"translation_filter", "strength", "0.0"},
+                         {"rotation_filter", "strength", "0.0"},
+                         {"debug", "input_script", InputScript}}))
+        {
+            return false;
+        }
+        std::string activate;
+        GetConfig()->GetString(Cfg::KeyActivate, activate);
+        std::ofstream script(localAppData / InputScript, std::ios::trunc);
+        script << "0 " << activate << "\n100 NONE\n";
+        script.close();
+
+        g_MotionStart = std::numeric_limits<XrTime>::max();
+        StubRuntime::SetMotion(
+            {[](XrTime time) {
+                 if (time < g_MotionStart)
+                 {
+                     return Pose::Identity();
+                 }
+                 const XrTime t = time - g_MotionStart;
+                 XrPosef rig = Rotation(10.0f * Wave(t, 2.0, 0.0), 5.0f * Wave(t, 1.3, 0.1), 5.0f * Wave(t, 0.9, 0.2));
+                 rig.position = {0.02f * Wave(t, 1.1, 0.3), 0.03f * Wave(t, 0.7, 0.4), 0.02f * Wave(t, 1.7, 0.5)};
+                 return rig;
+             },
+             [](XrTime time) {
+                 XrPosef head = Rotation(20.0f * Wave(time, 3.3, 0.0), 10.0f * Wave(time, 2.9, 0.6), 0.0f);
+                 head.position = {0.05f * Wave(time, 2.3, 0.7), 0.8f, -0.2f + 0.03f * Wave(time, 1.9, 0.8)};
+                 return head;
+             },
+             {{0.0f, 0.0f, 0.0f, 1.0f}, {0.3f, 0.5f, 0.0f}}});
+
+        // create the layer on top of the stub runtime, like the loader does
+        XrInstanceCreateInfo createInfo{XR_TYPE_INSTANCE_CREATE_INFO};
+        strcpy_s(createInfo.applicationInfo.applicationName, Application.c_str());
+        createInfo.applicationInfo.apiVersion = XR_CURRENT_API_VERSION;
+        XrApiLayerNextInfo nextInfo{XR_LOADER_INTERFACE_STRUCT_API_LAYER_NEXT_INFO,
+                                    XR_API_LAYER_NEXT_INFO_STRUCT_VERSION,
+                                    sizeof(XrApiLayerNextInfo)};
+        strcpy_s(nextInfo.layerName, LayerName.c_str());
+        nextInfo.nextGetInstanceProcAddr = StubRuntime::GetInstanceProcAddr;
+        nextInfo.nextCreateApiLayerInstance = StubRuntime::CreateApiLayerInstance;
+        XrApiLayerCreateInfo apiLayerInfo{XR_LOADER_INTERFACE_STRUCT_API_LAYER_CREATE_INFO,
+                                          XR_API_LAYER_CREATE_INFO_STRUCT_VERSION,
+                                          sizeof(XrApiLayerCreateInfo)};
+        apiLayerInfo.nextInfo = &nextInfo;
+        XrInstance instance{XR_NULL_HANDLE};
+        if (XR_FAILED(LAYER_NAMESPACE::xrCreateApiLayerInstance(&createInfo, &apiLayerInfo, &instance)))
+        {
+            std::cout << "unable to create instance\n";
+            return false;
+        }
+
+        Functions layer, runtime;
+        if (!ResolveFunctions(LAYER_NAMESPACE::xrGetInstanceProcAddr, instance, layer) ||
+            !ResolveFunctions(StubRuntime::GetInstanceProcAddr, instance, runtime))
+        {
+            return false;
+        }
+
+        XrSystemGetInfo systemGetInfo{XR_TYPE_SYSTEM_GET_INFO, nullptr, XR_FORM_FACTOR_HEAD_MOUNTED_DISPLAY};
+        XrSessionCreateInfo sessionCreateInfo{XR_TYPE_SESSION_CREATE_INFO};
+        XrSession session{XR_NULL_HANDLE};
+        XrSessionBeginInfo sessionBeginInfo{XR_TYPE_SESSION_BEGIN_INFO,
+                                            nullptr,
+                                            XR_VIEW_CONFIGURATION_TYPE_PRIMARY_STEREO};
+        XrReferenceSpaceCreateInfo localCreateInfo{XR_TYPE_REFERENCE_SPACE_CREATE_INFO,
+                                                   nullptr,
+                                                   XR_REFERENCE_SPACE_TYPE_LOCAL,
+                                                   Pose::Identity()};
+        XrReferenceSpaceCreateInfo viewCreateInfo{XR_TYPE_REFERENCE_SPACE_CREATE_INFO,
+                                                  nullptr,
+                                                  XR_REFERENCE_SPACE_TYPE_VIEW,
+                                                  Pose::Identity()};
+        XrSpace localSpace{XR_NULL_HANDLE}, viewSpace{XR_NULL_HANDLE};
+        if (XR_FAILED(layer.xrGetSystem(instance, &systemGetInfo, &sessionCreateInfo.systemId)) ||
+            XR_FAILED(layer.xrCreateSession(instance, &sessionCreateInfo, &session)) ||
+            XR_FAILED(layer.xrBeginSession(session, &sessionBeginInfo)) ||
+            XR_FAILED(layer.xrCreateReferenceSpace(session, &localCreateInfo, &localSpace)) ||
+            XR_FAILED(layer.xrCreateReferenceSpace(session, &viewCreateInfo, &viewSpace)))
+        {
+            std::cout << "unable to set up session\n";
+            layer.xrDestroyInstance(instance);
+            return false;
+        }
+
+        // frames in real time until the scripted shortcut has been processed
+        bool success{true};
+        const auto activationStart = std::chrono::steady_clock::now();
+        while (success && 0 == StubRuntime::GetTrackerQueries())
+        {
+            success = RunFrame(layer, session, localSpace, viewSpace, nullptr);
+            if (std::chrono::steady_clock::now() - activationStart > ActivationTimeout)
+            {
+                std::cout << "motion compensation was not activated\n";
+                success = false;
+            }
+            std::this_thread::sleep_for(2ms);
+        }
+        g_MotionStart = StubRuntime::GetLastSubmission().time + StubRuntime::FramePeriod;
+
+        // the same frames with and without the layer, the difference is the overhead of the layer
+        Result withLayer, withoutLayer;
+        success = success && RunFrames(layer, session, localSpace, viewSpace, withLayer) &&
+                  RunFrames(runtime, session, localSpace, viewSpace, withoutLayer);
+
+        layer.xrEndSession(session);
+        layer.xrDestroySession(session);
+        layer.xrDestroyInstance(instance);
+        if (!success)
+        {
+            return false;
+        }
+
+        std::cout << fmt::format("{} frames, time in microseconds, allocations and runtime calls per frame\n",
+                                 FrameCount);
+        std::cout << fmt::format("{:<10}{:>10}{:>10}{:>10}{:>10}{:>14}{:>12}{:>16}\n",
+                                 "",
+                                 "mean",
+                                 "median",
+                                 "p99",
+                                 "max",
+                                 "allocations",
+                                 "bytes",
+                                 "runtime calls");
+        PrintResult("layer", withLayer);
+        PrintResult("runtime", withoutLayer);
+        PrintFunctionCalls(withLayer, withoutLayer);
+        std::cout << fmt::format("max error of compensated poses: {:.6f} m, {:.4f} deg\n",
+                                 withLayer.viewPositionError,
+                                 withLayer.viewAngleError);
+        std::cout << fmt::format("max error of submitted poses: {:.6f} m, {:.4f} deg\n",
+                                 withLayer.submitPositionError,
+                                 withLayer.submitAngleError);
+        // activated frames are expected to run without heap allocations on the application thread
+        std::cout << fmt::format("allocations on application thread: {} in xrEndFrame, {} in total\n",
+                                 withLayer.endFrameAllocations,
+                                 withLayer.frameAllocations);
+
+        // the tracker action set is synced along with the application's actions, the layer must not sync again
+        const double syncCalls = GetCallsPerFrame(withLayer, "xrSyncActions");
+        if (1.0 != syncCalls)
+        {
+            std::cout << fmt::format("expected one xrSyncActions call per frame, got {:.2f}\n", syncCalls);
+        }
+
+        return 1.0 == syncCalls && 0 == withLayer.endFrameAllocations && 0 == withLayer.frameAllocations &&
+               withLayer.viewPositionError < PositionTolerance && withLayer.viewAngleError < AngleTolerance &&
+               withLayer.submitPositionError < PositionTolerance && withLayer.submitAngleError < AngleTolerance;
+    }
+
+    bool TracingBenchmark()
+    {
+        // the test executable doesn't run DllMain of the layer
+        if (FAILED(TraceLoggingRegister(log::g_traceProvider)))
+        {
+            std::cout << "unable to register trace provider\n";
+            return false;
+        }
+
+        const TraceResult disabled = MeasureTracing();
+        TraceSession session;
+        const bool enabled = session.Start() && TraceLoggingProviderEnabled(log::g_traceProvider, 0, 0);
+        TraceResult traced;
+        if (enabled)
+        {
+            traced = MeasureTracing();
+        }
+        session.Stop();
+        TraceLoggingUnregister(log::g_traceProvider);
+
+        std::cout << fmt::format("{} trace calls of a pose, time in nanoseconds, allocations per call\n", TraceCount);
+        std::cout << fmt::format("{:<14}{:>10}{:>14}{:>12}{:>14}\n",
+                                 "",
+                                 "raw",
+                                 "allocations",
+                                 "formatted",
+                                 "allocations");
+        PrintTraceResult("tracing off", disabled);
+        if (!enabled)
+        {
+            // not a failure, the overhead without a listener is still measured
+            std::cout << "tracing on: skipped, run as administrator to enable a trace session\n";
+            return 0.0 == disabled.rawAllocations;
+        }
+        PrintTraceResult("tracing on", traced);
+
+        // raw fields are written without formatting strings, with or without a listener
+        return 0.0 == disabled.rawAllocations && 0.0 == traced.rawAllocations;
+    }
+} // namespace Tests
@@ -0,0 +1,130 @@
+// Copyright(c) 2022 Sebastian Veith
+
+#include "pch.h"
+
+#include "tests.h"
+#include <utility.h>
+
+namespace
+{
+    const std::string Missing{"<missing>"};
+
+    struct Case
+    {
+        std::string section;
+        std::string key;
+        std::string expected;
+        // documented behavior of GetPrivateProfileString, which the parser replaces
+        bool compareWithWindows;
+    };
+
+    const std::string ByteOrderMark{"\xEF\xBB\xBF"};
+    const std::string Content{"[First]\n"
+                              "plain=value\n"
+                              "  spaced  =   value with spaces   \r\n"
+                              "quoted=\"  quoted value  \"\n"
+                              "single='single'\n"
+                              "unbalanced=\"open\n"
+                              "MixedCase=Upper\n"
+                              "duplicate=first\n"
+                              "duplicate=second\n"
+                              "; commented=ignored\n"
+                              "inline=value ; not a comment\n"
+                              "no separator\n"
+                              "empty=\n"
+                              "[ Second \n"
+                              "key=second section\n"
+                              "[third]\n"
+                              "key=third section\n"};
+
+    const std::vector<Case> Cases{{"First", "plain", "value", true},
+                                  {"First", "spaced", "value with spaces", true},
+                                  {"First", "quoted", "  quoted value  ", true},
+                                  {"First", "single", "single", true},
+                                  {"First", "unbalanced", "\"open", true},
+                                  // names are case insensitive, values keep their case
+                                  {"FIRST", "mixedcase", "Upper", true},
+                                  // first occurrence wins, like GetPrivateProfileString
+                                  {"First", "duplicate", "first", true},
+                                  {"First", "commented", Missing, true},
+                                  {"First", "; commented", Missing, false},
+                                  {"First", "inline", "value ; not a comment", true},
+                                  {"First", "no separator", Missing, false},
+                                  {"First", "empty", "", true},
+                                  // section header without closing bracket extends to the end of the line
+                                  {"Second", "key", "second section", false},
+                                  {"THIRD", "KEY", "third section", true},
+                                  {"First", "key", Missing, true},
+                                  {"Fourth", "key", Missing, true}};
+} // namespace
+
+namespace Tests
+{
+    bool IniFileTest()
+    {
+        const std::filesystem::path directory = std::filesystem::temp_directory_path() / "OXRMC_LayerTests";
+        std::error_code error;
+        std::filesystem::create_directories(directory, error);
+        // windows is given the file without byte order mark, the parser has to skip it
+        const std::string path = (directory / "ini_test.ini").string();
+        const std::string pathWithBom = (directory / "ini_test_bom.ini").string();
+        std::ofstream(path, std::ios::trunc | std::ios::binary) << Content;
+        std::ofstream(pathWithBom, std::ios::trunc | std::ios::binary) << ByteOrderMark << Content;
+
+        utility::IniFile ini;
+        if (!ini.Load(pathWithBom))
+        {
+            std::cout << "unable to load " << pathWithBom << "\n";
+            return false;
+        }
+
+        int failures{0};
+        for (const auto& [section, key, expected, compareWithWindows] : Cases)
+        {
+            std::string value;
+            if (!ini.Get(section, key, value))
+            {
+                value = Missing;
+            }
+            if (expected != value)
+            {
+                std::cout << fmt::format("[{}] {}: expected '{}', got '{}'\n", section, key, expected, value);
+                failures++;
+            }
+            if (compareWithWindows)
+            {
+                char buffer[256];
+                GetPrivateProfileString(section.c_str(),
+                                        key.c_str(),
+                                        Missing.c_str(),
+                                        buffer,
+                                        sizeof(buffer),
+                                        path.c_str());
+                if (value != buffer)
+                {
+                    std::cout << fmt::format("[{}] {}: GetPrivateProfileString returns '{}', parser '{}'\n",
+                                             section,
+                                             key,
+                                             buffer,
+                                             value);
+                    failures++;
+                }
+            }
+        }
+
+        if (ini.Load((directory / "missing.ini").string()))
+        {
+            std::cout << "loading a missing file succeeded\n";
+            failures++;
+        }
+        std::string value;
+        if (ini.Get("First", "plain", value))
+        {
+            std::cout << "entries of previously loaded file are kept\n";
+            failures++;
+        }
+
+        std::cout << Cases.size() << " cases, " << failures << " failures\n";
+        return 0 == failures;
+    }
+} // namespace Tests
@@ -0,0 +1,121 @@
+// Copyright(c) 2022 Sebastian Veith
+
+#include "pch.h"
+
+#include "tests.h"
+#include <config.h>
+#include <layer.h>
+#include <utility.h>
+
+using namespace motion_compensation_layer;
+
+namespace
+{
+    const std::string Application{"LayerKeyboardTest"};
+    const std::string InputScript{"keyboard_input.txt"};
+
+    struct ReceivedEvent
+    {
+        Cfg key;
+        bool isRepeat;
+        std::chrono::milliseconds time;
+    };
+
+    // consumes events like the frame thread does, until the given time since start
+    std::vector<ReceivedEvent> PollUntil(utility::KeyboardInput& input,
+                                         std::chrono::steady_clock::time_point start,
+                                         std::chrono::milliseconds end)
+    {
+        std::vector<ReceivedEvent> events;
+        while (std::chrono::steady_clock::now() - start < end)
+        {
+            Cfg key;
+            bool isRepeat;
+            while (input.GetEvent(key, isRepeat))
+            {
+                events.push_back(
+                    {key,
+                     isRepeat,
+                     std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start)});
+            }
+            std::this_thread::sleep_for(5ms);
+        }
+        return events;
+    }
+
+    bool Expect(const std::string& phase,
+                const std::vector<ReceivedEvent>& events,
+                const std::vector<std::pair<Cfg, bool>>& expected)
+    {
+        bool success = events.size() == expected.size();
+        for (size_t i = 0; success && i < events.size(); i++)
+        {
+            success = events[i].key == expected[i].first && events[i].isRepeat == expected[i].second;
+        }
+        if (!success)
+        {
+            std::cout << phase << ": expected " << expected.size() << " event(s), got:\n";
+            for (const auto& event : events)
+            {
+                std::cout << fmt::format("  shortcut {} {} at {} ms\n",
+                                         (int)event.key - (int)Cfg::KeyActivate,
+                                         event.isRepeat ? "repetition" : "press",
+                                         event.time.count());
+            }
+        }
+        return success;
+    }
+} // namespace
+
+namespace Tests
+{
+    bool KeyboardTest()
+    {
+        if (!InitConfig(Application, {{"debug", "input_script", InputScript}}))
+        {
+            return false;
+        }
+        std::string activate;
+        GetConfig()->GetString(Cfg::KeyActivate, activate);
+
+        // milliseconds since first initialization of the keyboard input
+        std::ofstream script(localAppData / InputScript, std::ios::trunc);
+        script << "100 " << activate << "\n"  // press, repeated once after 300 ms
+               << "550 NONE\n"
+               << "700 " << activate << "\n"  // held while reloading the configuration at 800 ms
+               << "1000 NONE\n"
+               << "1200 " << activate << "\n" // not consumed before it gets stale
+               << "1300 NONE\n"
+               << "1700 " << activate << "\n" // consumed in time again
+               << "1800 NONE\n";
+        script.close();
+
+        utility::KeyboardInput input;
+        const auto start = std::chrono::steady_clock::now();
+        if (!input.Init())
+        {
+            std::cout << "unable to initialize keyboard input\n";
+            return false;
+        }
+
+        bool success = Expect("press and repetition",
+                              PollUntil(input, start, 650ms),
+                              {{Cfg::KeyActivate, false}, {Cfg::KeyActivate, true}});
+
+        success = Expect("press before reload", PollUntil(input, start, 800ms), {{Cfg::KeyActivate, false}}) &&
+                  success;
+        if (!input.Init())
+        {
+            std::cout << "unable to reinitialize keyboard input\n";
+            return false;
+        }
+        success = Expect("held during reload", PollUntil(input, start, 1150ms), {}) && success;
+
+        std::this_thread::sleep_until(start + 1600ms);
+        success = Expect("stale press", PollUntil(input, start, 1650ms), {}) && success;
+
+        success = Expect("press after stale one", PollUntil(input, start, 1900ms), {{Cfg::KeyActivate, false}}) &&
+                  success;
+        return success;
+    }
+} // namespace Tests
@@ -0,0 +1,78 @@
+// Copyright(c) 2022 Sebastian Veith
+
+#include "pch.h"
+
+#include "tests.h"
+#include <config.h>
+#include <layer.h>
+#include <log.h>
+
+using namespace motion_compensation_layer;
+
+namespace Tests
+{
+    bool InitConfig(const std::string& application, const ConfigOverrides& overrides)
+    {
+        char path[_MAX_PATH];
+        GetModuleFileNameA(nullptr, path, sizeof(path));
+        const std::filesystem::path exeDir = std::filesystem::path(path).parent_path();
+
+        // keep the user's configuration untouched
+        localAppData = std::filesystem::temp_directory_path() / "OXRMC_LayerTests";
+        std::error_code error;
+        std::filesystem::create_directories(localAppData, error);
+        std::filesystem::copy_file(exeDir / (LayerPrettyName + ".ini"),
+                                   localAppData / (LayerPrettyName + ".ini"),
+                                   std::filesystem::copy_options::overwrite_existing,
+                                   error);
+        if (error)
+        {
+            std::cout << "unable to copy default configuration: " << error.message() << "\n";
+            return false;
+        }
+
+        const std::string appIni = (localAppData / (application + ".ini")).string();
+        std::filesystem::remove(appIni, error);
+        for (const auto& [section, key, value] : overrides)
+        {
+            WritePrivateProfileString(section.c_str(), key.c_str(), value.c_str(), appIni.c_str());
+        }
+        if (!GetConfig()->Init(application))
+        {
+            std::cout << "unable to initialize configuration\n";
+            return false;
+        }
+        return true;
+    }
+} // namespace Tests
+
+int main(int argc, char* argv[])
+{
+    const std::vector<std::pair<std::string, std::function<bool()>>> tests{{"snapshot", Tests::SnapshotStressTest},
+                                                                           {"benchmark", Tests::Benchmark},
+                                                                           {"tracing", Tests::TracingBenchmark},
+                                                                           {"ini", Tests::IniFileTest},
+                                                                           {"keyboard", Tests::KeyboardTest},
+                                                                           {"overlay", Tests::OverlayMeshTest}};
+
+    const std::string selected = argc > 1 ? argv[1] : "";
+    bool success{true}, found{false};
+    for (const auto& [name, test] : tests)
+    {
+        if (!selected.empty() && selected != name)
+        {
+            continue;
+        }
+        found = true;
+        std::cout << "running " << name << "\n";
+        const bool passed = test();
+        std::cout << name << (passed ? " passed" : " FAILED") << "\n";
+        success = passed && success;
+    }
+    if (!found)
+    {
+        std::cout << "unknown test: " << selected << "\n";
+        return 1;
+    }
+    return success ? 0 : 1;
+}
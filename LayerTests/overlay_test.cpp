@@ -0,0 +1,154 @@
+// Copyright(c) 2022 Sebastian Veith
+
+#include "pch.h"
+
+#include "tests.h"
+#include <overlay.h>
+
+using namespace graphics;
+
+namespace
+{
+    constexpr int Segments{32};
+    constexpr size_t ExpectedVertices{3 * (Segments + 2)};
+    constexpr size_t ExpectedIndices{3 * Segments * 6};
+    constexpr float Tolerance{0.0001f};
+
+    // triangle list of a cone as built before the mesh was indexed, three vertices per triangle
+    void AppendConeTriangles(XrVector3f top,
+                             XrVector3f side,
+                             XrVector3f offset,
+                             XrVector3f topColor,
+                             XrVector3f sideColor,
+                             XrVector3f bottomColor,
+                             std::vector<SimpleMeshVertex>& triangles)
+    {
+        const DirectX::XMVECTOR dxTop = xr::math::LoadXrVector3(top);
+        const DirectX::XMVECTOR dxOffset = xr::math::LoadXrVector3(offset);
+        XrVector3f xrTop;
+        xr::math::StoreXrVector3(&xrTop, DirectX::XMVectorAdd(dxTop, dxOffset));
+        const DirectX::XMVECTOR rotation = DirectX::XMQuaternionRotationAxis(dxTop, DirectX::XM_2PI / (float)Segments);
+        DirectX::XMVECTOR side1 = xr::math::LoadXrVector3(side);
+        XrVector3f xrSide0, xrSide1;
+        for (int i = 0; i < Segments; i++)
+        {
+            const DirectX::XMVECTOR side0 = side1;
+            side1 = DirectX::XMVector3Rotate(side0, rotation);
+            xr::math::StoreXrVector3(&xrSide0, DirectX::XMVectorAdd(side0, dxOffset));
+            xr::math::StoreXrVector3(&xrSide1, DirectX::XMVectorAdd(side1, dxOffset));
+
+            // bottom
+            triangles.push_back({offset, bottomColor});
+            triangles.push_back({xrSide0, sideColor});
+            triangles.push_back({xrSide1, sideColor});
+
+            // top
+            triangles.push_back({xrTop, topColor});
+            triangles.push_back({xrSide1, sideColor});
+            triangles.push_back({xrSide0, sideColor});
+        }
+    }
+
+    std::vector<SimpleMeshVertex> CreateMarkerTriangles(bool rgb)
+    {
+        std::vector<SimpleMeshVertex> triangles;
+        AppendConeTriangles({-4.f, 0.f, 0.f},
+                            {-1.5f, 0.5f, 0.f},
+                            {0.f, 0.f, 0.f},
+                            rgb ? DarkRed : DarkMagenta,
+                            rgb ? Red : Magenta,
+                            rgb ? LightRed : LightMagenta,
+                            triangles);
+        AppendConeTriangles({0.f, 4.f, 0.f},
+                            {0.f, 1.5f, 0.5f},
+                            {0.f, 0.f, 0.f},
+                            rgb ? DarkBlue : DarkCyan,
+                            rgb ? Blue : Cyan,
+                            rgb ? LightBlue : LightCyan,
+                            triangles);
+        AppendConeTriangles({0.f, 0.f, 4.f},
+                            {0.5f, 0.f, 1.5f},
+                            {0.f, 0.f, 0.f},
+                            rgb ? DarkGreen : DarkYellow,
+                            rgb ? Green : Yellow,
+                            rgb ? LightGreen : LightYellow,
+                            triangles);
+        return triangles;
+    }
+
+    bool IsEqual(const XrVector3f& a, const XrVector3f& b)
+    {
+        return fabs(a.x - b.x) < Tolerance && fabs(a.y - b.y) < Tolerance && fabs(a.z - b.z) < Tolerance;
+    }
+
+    DirectX::XMVECTOR Normal(const XrVector3f& a, const XrVector3f& b, const XrVector3f& c)
+    {
+        const DirectX::XMVECTOR dxA = xr::math::LoadXrVector3(a);
+        return DirectX::XMVector3Cross(DirectX::XMVectorSubtract(xr::math::LoadXrVector3(b), dxA),
+                                       DirectX::XMVectorSubtract(xr::math::LoadXrVector3(c), dxA));
+    }
+
+    bool CheckMarker(bool rgb)
+    {
+        const char* name = rgb ? "rgb" : "cmy";
+        std::vector<SimpleMeshVertex> vertices;
+        std::vector<uint16_t> indices;
+        Overlay::CreateMarker(rgb, vertices, indices);
+        const std::vector<SimpleMeshVertex> triangles = CreateMarkerTriangles(rgb);
+
+        if (ExpectedVertices != vertices.size() || ExpectedIndices != indices.size() ||
+            triangles.size() != indices.size())
+        {
+            std::cout << fmt::format("{} marker: {} vertices, {} indices, expected {} and {}\n",
+                                     name,
+                                     vertices.size(),
+                                     indices.size(),
+                                     ExpectedVertices,
+                                     ExpectedIndices);
+            return false;
+        }
+        const auto outOfRange = std::find_if(indices.cbegin(), indices.cend(), [&vertices](uint16_t index) {
+            return index >= vertices.size();
+        });
+        if (indices.cend() != outOfRange)
+        {
+            std::cout << fmt::format("{} marker: index {} out of range\n", name, *outOfRange);
+            return false;
+        }
+
+        // same corners in the same order, so the winding of every triangle is unchanged
+        int failures{0};
+        for (size_t i = 0; i < indices.size(); i += 3)
+        {
+            bool isEqual{true};
+            for (size_t j = i; j < i + 3; j++)
+            {
+                isEqual = isEqual && IsEqual(vertices[indices[j]].Position, triangles[j].Position) &&
+                          IsEqual(vertices[indices[j]].Color, triangles[j].Color);
+            }
+            // facing the same side
+            const DirectX::XMVECTOR normal = Normal(vertices[indices[i]].Position,
+                                                    vertices[indices[i + 1]].Position,
+                                                    vertices[indices[i + 2]].Position);
+            const DirectX::XMVECTOR expectedNormal =
+                Normal(triangles[i].Position, triangles[i + 1].Position, triangles[i + 2].Position);
+            isEqual = isEqual && DirectX::XMVectorGetX(DirectX::XMVector3Dot(normal, expectedNormal)) > 0.f;
+            if (!isEqual)
+            {
+                std::cout << fmt::format("{} marker: triangle {} differs from triangle list\n", name, i / 3);
+                failures++;
+            }
+        }
+        return 0 == failures;
+    }
+} // namespace
+
+namespace Tests
+{
+    bool OverlayMeshTest()
+    {
+        const bool rgb = CheckMarker(true);
+        const bool cmy = CheckMarker(false);
+        return rgb && cmy;
+    }
+} // namespace Tests
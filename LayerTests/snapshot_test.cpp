@@ -0,0 +1,161 @@
+// Copyright(c) 2022 Sebastian Veith
+
+#include "pch.h"
+
+#include "tests.h"
+#include <tracker.h>
+#include <util.h>
+
+using namespace xr::math;
+
+namespace
+{
+    constexpr XrTime FramePeriod{11111111}; // 90 Hz
+    constexpr int FrameCount{20000};
+    constexpr int ReaderCount{4};
+    constexpr float Tolerance{0.0001f};
+
+    // each frame has a distinct tracker pose, so a delta paired with the wrong time is detected
+    XrPosef TrackerPoseAt(XrTime time)
+    {
+        const int64_t frame = time / FramePeriod;
+        XrPosef pose{Pose::Identity()};
+        StoreXrQuaternion(&pose.orientation,
+                          DirectX::XMQuaternionRotationRollPitchYaw(0.0f,
+                                                                    (float)(frame % 360) * Tracker::angleToRadian,
+                                                                    0.0f));
+        pose.position = {(float)(frame % 1000) * 0.001f, 0.0f, 0.0f};
+        return pose;
+    }
+
+    class TestTracker : public Tracker::TrackerBase
+    {
+      public:
+        bool ResetReferencePose(XrSession session, XrTime time) override
+        {
+            SetReferencePose(Pose::Identity());
+            return true;
+        }
+
+        void SwitchReferencePose(const XrPosef& pose)
+        {
+            SetReferencePose(pose);
+        }
+
+        std::atomic<uint64_t> m_Calculations{0};
+
+      protected:
+        bool GetPose(XrPosef& trackerPose, XrSession session, XrTime time) override
+        {
+            m_Calculations++;
+            trackerPose = TrackerPoseAt(time);
+            return true;
+        }
+    };
+
+    bool IsEqual(const XrPosef& a, const XrPosef& b)
+    {
+        // q and -q describe the same rotation
+        const float dot = a.orientation.x * b.orientation.x + a.orientation.y * b.orientation.y +
+                          a.orientation.z * b.orientation.z + a.orientation.w * b.orientation.w;
+        return fabs(fabs(dot) - 1.0f) < Tolerance && fabs(a.position.x - b.position.x) < Tolerance &&
+               fabs(a.position.y - b.position.y) < Tolerance && fabs(a.position.z - b.position.z) < Tolerance;
+    }
+} // namespace
+
+namespace Tests
+{
+    bool SnapshotStressTest()
+    {
+        // unfiltered poses make the expected delta independent of previous requests
+        if (!InitConfig("LayerTests",
+                        {{"translation_filter", "strength", "0.0"}, {"rotation_filter", "strength", "0.0"}}))
+        {
+            return false;
+        }
+        TestTracker tracker;
+        if (!tracker.Init() || !tracker.ResetReferencePose(XR_NULL_HANDLE, 0))
+        {
+            std::cout << "unable to initialize tracker\n";
+            return false;
+        }
+
+        // the reference pose is switched concurrently, every delta has to match one of them
+        XrPosef references[2]{Pose::Identity(), Pose::Identity()};
+        StoreXrQuaternion(&references[1].orientation,
+                          DirectX::XMQuaternionRotationRollPitchYaw(0.0f, 90.0f * Tracker::angleToRadian, 0.0f));
+        references[1].position = {0.0f, 1.0f, 0.5f};
+
+        std::atomic<XrTime> latest{0};
+        std::atomic_bool stop{false};
+        std::atomic<uint64_t> requests{0}, failures{0};
+        std::mutex outputMutex;
+
+        auto check = [&](XrTime time) {
+            XrPosef delta{};
+            requests++;
+            bool valid = tracker.GetPoseDelta(delta, XR_NULL_HANDLE, time);
+            if (valid)
+            {
+                const XrPosef inverse = Pose::Invert(TrackerPoseAt(time));
+                valid = IsEqual(delta, Pose::Multiply(inverse, references[0])) ||
+                        IsEqual(delta, Pose::Multiply(inverse, references[1]));
+            }
+            if (!valid && failures++ < 10)
+            {
+                std::unique_lock lock(outputMutex);
+                std::cout << "inconsistent delta for time " << time << ": " << xr::ToString(delta) << "\n";
+            }
+        };
+
+        // frame thread publishes a delta for each new display time, like the delta worker does
+        std::thread frames([&] {
+            for (int frame = 1; frame <= FrameCount; frame++)
+            {
+                const XrTime time = frame * FramePeriod;
+                check(time);
+                latest = time;
+                std::this_thread::yield();
+            }
+            stop = true;
+        });
+
+        // readers mostly reuse the current snapshot, requests for the previous frame force recalculation
+        std::vector<std::thread> readers;
+        for (int reader = 0; reader < ReaderCount; reader++)
+        {
+            readers.emplace_back([&, reader] {
+                uint64_t count{0};
+                while (!stop)
+                {
+                    const XrTime time = latest;
+                    if (time)
+                    {
+                        check(0 == ++count % (reader + 8) && time > FramePeriod ? time - FramePeriod : time);
+                    }
+                }
+            });
+        }
+
+        std::thread mutator([&] {
+            size_t index{0};
+            while (!stop)
+            {
+                index ^= 1;
+                tracker.SwitchReferencePose(references[index]);
+                std::this_thread::sleep_for(1ms);
+            }
+        });
+
+        frames.join();
+        for (auto& reader : readers)
+        {
+            reader.join();
+        }
+        mutator.join();
+
+        std::cout << requests << " requests, " << tracker.m_Calculations << " calculations, " << failures
+                  << " inconsistent deltas\n";
+        return 0 == failures;
+    }
+} // namespace Tests
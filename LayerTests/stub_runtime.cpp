@@ -0,0 +1,585 @@
+// Copyright(c) 2022 Sebastian Veith
+
+#include "pch.h"
+
+#include "stub_runtime.h"
+
+using namespace xr::math;
+
+namespace Tests::StubRuntime
+{
+    namespace
+    {
+        enum class SpaceType
+        {
+            Local,
+            Stage,
+            View,
+            Controller
+        };
+
+        struct Space
+        {
+            SpaceType type;
+            XrPosef offset;
+        };
+
+        struct State
+        {
+            Motion motion{[](XrTime) { return Pose::Identity(); }, [](XrTime) { return Pose::Identity(); }};
+            std::mutex mutex;
+            uint64_t nextHandle{0};
+            std::unordered_map<uint64_t, Space> spaces;
+            std::vector<std::string> paths;
+            XrTime displayTime{0};
+            std::atomic<uint64_t> trackerQueries{0};
+            Submission submission;
+        };
+
+        State& GetState()
+        {
+            static State state;
+            return state;
+        }
+
+        template <typename T>
+        T NewHandle()
+        {
+            std::unique_lock lock(GetState().mutex);
+            return reinterpret_cast<T>(++GetState().nextHandle);
+        }
+
+        XrPosef GetEyeOffset(uint32_t eye)
+        {
+            XrPosef offset{Pose::Identity()};
+            offset.position.x = 0 == eye ? -0.032f : 0.032f;
+            return offset;
+        }
+
+        XrPosef GetViewPose(XrTime time)
+        {
+            const State& state = GetState();
+            return Pose::Multiply(state.motion.head(time), state.motion.rig(time));
+        }
+
+        // pose of the space in local space
+        bool GetSpacePose(XrSpace handle, XrTime time, XrPosef& pose)
+        {
+            State& state = GetState();
+            std::unique_lock lock(state.mutex);
+            const auto space = state.spaces.find(reinterpret_cast<uint64_t>(handle));
+            if (state.spaces.end() == space)
+            {
+                return false;
+            }
+            const XrPosef origin = SpaceType::View == space->second.type ? GetViewPose(time)
+                                   : SpaceType::Controller == space->second.type
+                                       ? Pose::Multiply(state.motion.controller, state.motion.rig(time))
+                                       : Pose::Identity();
+            pose = Pose::Multiply(space->second.offset, origin);
+            return true;
+        }
+
+        XrSpace AddSpace(SpaceType type, const XrPosef& offset)
+        {
+            const XrSpace space = NewHandle<XrSpace>();
+            std::unique_lock lock(GetState().mutex);
+            GetState().spaces[reinterpret_cast<uint64_t>(space)] = {type, offset};
+            return space;
+        }
+
+        // instance
+
+        XrResult XRAPI_CALL xrEnumerateInstanceExtensionProperties(const char* layerName,
+                                                                   uint32_t propertyCapacityInput,
+                                                                   uint32_t* propertyCountOutput,
+                                                                   XrExtensionProperties* properties)
+        {
+            const std::vector<const char*> extensions{XR_HTCX_VIVE_TRACKER_INTERACTION_EXTENSION_NAME,
+                                                      XR_KHR_WIN32_CONVERT_PERFORMANCE_COUNTER_TIME_EXTENSION_NAME};
+            *propertyCountOutput = (uint32_t)extensions.size();
+            if (0 == propertyCapacityInput)
+            {
+                return XR_SUCCESS;
+            }
+            if (propertyCapacityInput < extensions.size())
+            {
+                return XR_ERROR_SIZE_INSUFFICIENT;
+            }
+            for (size_t i = 0; i < extensions.size(); i++)
+            {
+                strcpy_s(properties[i].extensionName, extensions[i]);
+                properties[i].extensionVersion = 1;
+            }
+            return XR_SUCCESS;
+        }
+
+        XrResult XRAPI_CALL xrDestroyInstance(XrInstance instance)
+        {
+            return XR_SUCCESS;
+        }
+
+        XrResult XRAPI_CALL xrGetInstanceProperties(XrInstance instance, XrInstanceProperties* instanceProperties)
+        {
+            strcpy_s(instanceProperties->runtimeName, "OXRMC stub runtime");
+            instanceProperties->runtimeVersion = XR_MAKE_VERSION(1, 0, 0);
+            return XR_SUCCESS;
+        }
+
+        XrResult XRAPI_CALL xrGetSystem(XrInstance instance, const XrSystemGetInfo* getInfo, XrSystemId* systemId)
+        {
+            if (XR_FORM_FACTOR_HEAD_MOUNTED_DISPLAY != getInfo->formFactor)
+            {
+                return XR_ERROR_FORM_FACTOR_UNSUPPORTED;
+            }
+            *systemId = 1;
+            return XR_SUCCESS;
+        }
+
+        XrResult XRAPI_CALL xrGetSystemProperties(XrInstance instance,
+                                                  XrSystemId systemId,
+                                                  XrSystemProperties* properties)
+        {
+            properties->systemId = systemId;
+            strcpy_s(properties->systemName, "stub headset");
+            return XR_SUCCESS;
+        }
+
+        XrResult XRAPI_CALL xrConvertWin32PerformanceCounterToTimeKHR(XrInstance instance,
+                                                                      const LARGE_INTEGER* performanceCounter,
+                                                                      XrTime* time)
+        {
+            LARGE_INTEGER frequency;
+            QueryPerformanceFrequency(&frequency);
+            *time = performanceCounter->QuadPart / frequency.QuadPart * 1000000000 +
+                    performanceCounter->QuadPart % frequency.QuadPart * 1000000000 / frequency.QuadPart;
+            return XR_SUCCESS;
+        }
+
+        // paths and actions
+
+        XrResult XRAPI_CALL xrStringToPath(XrInstance instance, const char* pathString, XrPath* path)
+        {
+            State& state = GetState();
+            std::unique_lock lock(state.mutex);
+            const auto existing = std::find(state.paths.cbegin(), state.paths.cend(), pathString);
+            *path = (XrPath)(existing - state.paths.cbegin()) + 1;
+            if (state.paths.cend() == existing)
+            {
+                state.paths.push_back(pathString);
+            }
+            return XR_SUCCESS;
+        }
+
+        XrResult XRAPI_CALL xrPathToString(XrInstance instance,
+                                           XrPath path,
+                                           uint32_t bufferCapacityInput,
+                                           uint32_t* bufferCountOutput,
+                                           char* buffer)
+        {
+            State& state = GetState();
+            std::unique_lock lock(state.mutex);
+            if (XR_NULL_PATH == path || path > state.paths.size())
+            {
+                return XR_ERROR_PATH_INVALID;
+            }
+            const std::string& pathString = state.paths[path - 1];
+            *bufferCountOutput = (uint32_t)pathString.size() + 1;
+            if (0 == bufferCapacityInput)
+            {
+                return XR_SUCCESS;
+            }
+            if (bufferCapacityInput < *bufferCountOutput)
+            {
+                return XR_ERROR_SIZE_INSUFFICIENT;
+            }
+            memcpy(buffer, pathString.c_str(), *bufferCountOutput);
+            return XR_SUCCESS;
+        }
+
+        XrResult XRAPI_CALL xrCreateActionSet(XrInstance instance,
+                                              const XrActionSetCreateInfo* createInfo,
+                                              XrActionSet* actionSet)
+        {
+            *actionSet = NewHandle<XrActionSet>();
+            return XR_SUCCESS;
+        }
+
+        XrResult XRAPI_CALL xrDestroyActionSet(XrActionSet actionSet)
+        {
+            return XR_SUCCESS;
+        }
+
+        XrResult XRAPI_CALL xrCreateAction(XrActionSet actionSet,
+                                           const XrActionCreateInfo* createInfo,
+                                           XrAction* action)
+        {
+            *action = NewHandle<XrAction>();
+            return XR_SUCCESS;
+        }
+
+        XrResult XRAPI_CALL xrDestroyAction(XrAction action)
+        {
+            return XR_SUCCESS;
+        }
+
+        XrResult XRAPI_CALL
+        xrSuggestInteractionProfileBindings(XrInstance instance,
+                                            const XrInteractionProfileSuggestedBinding* suggestedBindings)
+        {
+            return XR_SUCCESS;
+        }
+
+        XrResult XRAPI_CALL xrAttachSessionActionSets(XrSession session,
+                                                      const XrSessionActionSetsAttachInfo* attachInfo)
+        {
+            return XR_SUCCESS;
+        }
+
+        XrResult XRAPI_CALL xrGetCurrentInteractionProfile(XrSession session,
+                                                           XrPath topLevelUserPath,
+                                                           XrInteractionProfileState* interactionProfile)
+        {
+            interactionProfile->interactionProfile = XR_NULL_PATH;
+            return XR_SUCCESS;
+        }
+
+        XrResult XRAPI_CALL xrSyncActions(XrSession session, const XrActionsSyncInfo* syncInfo)
+        {
+            return XR_SUCCESS;
+        }
+
+        XrResult XRAPI_CALL xrGetActionStatePose(XrSession session,
+                                                 const XrActionStateGetInfo* getInfo,
+                                                 XrActionStatePose* state)
+        {
+            GetState().trackerQueries++;
+            state->isActive = XR_TRUE;
+            return XR_SUCCESS;
+        }
+
+        // session and spaces
+
+        XrResult XRAPI_CALL xrCreateSession(XrInstance instance,
+                                            const XrSessionCreateInfo* createInfo,
+                                            XrSession* session)
+        {
+            *session = NewHandle<XrSession>();
+            return XR_SUCCESS;
+        }
+
+        XrResult XRAPI_CALL xrDestroySession(XrSession session)
+        {
+            return XR_SUCCESS;
+        }
+
+        XrResult XRAPI_CALL xrBeginSession(XrSession session, const XrSessionBeginInfo* beginInfo)
+        {
+            return XR_SUCCESS;
+        }
+
+        XrResult XRAPI_CALL xrEndSession(XrSession session)
+        {
+            return XR_SUCCESS;
+        }
+
+        XrResult XRAPI_CALL xrCreateReferenceSpace(XrSession session,
+                                                   const XrReferenceSpaceCreateInfo* createInfo,
+                                                   XrSpace* space)
+        {
+            const SpaceType type = XR_REFERENCE_SPACE_TYPE_VIEW == createInfo->referenceSpaceType    ? SpaceType::View
+                                   : XR_REFERENCE_SPACE_TYPE_STAGE == createInfo->referenceSpaceType ? SpaceType::Stage
+                                                                                                     : SpaceType::Local;
+            *space = AddSpace(type, createInfo->poseInReferenceSpace);
+            return XR_SUCCESS;
+        }
+
+        XrResult XRAPI_CALL xrCreateActionSpace(XrSession session,
+                                                const XrActionSpaceCreateInfo* createInfo,
+                                                XrSpace* space)
+        {
+            // the only pose action is the one of the layer's tracker
+            *space = AddSpace(SpaceType::Controller, createInfo->poseInActionSpace);
+            return XR_SUCCESS;
+        }
+
+        XrResult XRAPI_CALL xrDestroySpace(XrSpace space)
+        {
+            std::unique_lock lock(GetState().mutex);
+            GetState().spaces.erase(reinterpret_cast<uint64_t>(space));
+            return XR_SUCCESS;
+        }
+
+        XrResult XRAPI_CALL xrLocateSpace(XrSpace space, XrSpace baseSpace, XrTime time, XrSpaceLocation* location)
+        {
+            XrPosef pose, basePose;
+            if (!GetSpacePose(space, time, pose) || !GetSpacePose(baseSpace, time, basePose))
+            {
+                return XR_ERROR_HANDLE_INVALID;
+            }
+            location->pose = Pose::Multiply(pose, Pose::Invert(basePose));
+            location->locationFlags = XR_SPACE_LOCATION_ORIENTATION_VALID_BIT | XR_SPACE_LOCATION_POSITION_VALID_BIT |
+                                      XR_SPACE_LOCATION_ORIENTATION_TRACKED_BIT |
+                                      XR_SPACE_LOCATION_POSITION_TRACKED_BIT;
+            return XR_SUCCESS;
+        }
+
+        XrResult XRAPI_CALL xrLocateViews(XrSession session,
+                                          const XrViewLocateInfo* viewLocateInfo,
+                                          XrViewState* viewState,
+                                          uint32_t viewCapacityInput,
+                                          uint32_t* viewCountOutput,
+                                          XrView* views)
+        {
+            *viewCountOutput = ViewCount;
+            if (0 == viewCapacityInput)
+            {
+                return XR_SUCCESS;
+            }
+            if (viewCapacityInput < ViewCount)
+            {
+                return XR_ERROR_SIZE_INSUFFICIENT;
+            }
+            XrPosef basePose;
+            if (!GetSpacePose(viewLocateInfo->space, viewLocateInfo->displayTime, basePose))
+            {
+                return XR_ERROR_HANDLE_INVALID;
+            }
+            const XrPosef inverseBase = Pose::Invert(basePose);
+            for (uint32_t i = 0; i < ViewCount; i++)
+            {
+                views[i].pose = Pose::Multiply(GetEyePose(i, viewLocateInfo->displayTime), inverseBase);
+                views[i].fov = {-0.8f, 0.8f, 0.8f, -0.8f};
+            }
+            viewState->viewStateFlags = XR_VIEW_STATE_ORIENTATION_VALID_BIT | XR_VIEW_STATE_POSITION_VALID_BIT |
+                                        XR_VIEW_STATE_ORIENTATION_TRACKED_BIT | XR_VIEW_STATE_POSITION_TRACKED_BIT;
+            return XR_SUCCESS;
+        }
+
+        // frames
+
+        XrResult XRAPI_CALL xrWaitFrame(XrSession session,
+                                        const XrFrameWaitInfo* frameWaitInfo,
+                                        XrFrameState* frameState)
+        {
+            // display time advances by one period per frame, independent of the actual duration
+            State& state = GetState();
+            state.displayTime += FramePeriod;
+            frameState->predictedDisplayTime = state.displayTime;
+            frameState->predictedDisplayPeriod = FramePeriod;
+            frameState->shouldRender = XR_TRUE;
+            return XR_SUCCESS;
+        }
+
+        XrResult XRAPI_CALL xrBeginFrame(XrSession session, const XrFrameBeginInfo* frameBeginInfo)
+        {
+            return XR_SUCCESS;
+        }
+
+        XrResult XRAPI_CALL xrEndFrame(XrSession session, const XrFrameEndInfo* frameEndInfo)
+        {
+            Submission& submission = GetState().submission;
+            submission = {frameEndInfo->displayTime, 0, {}};
+            for (uint32_t i = 0; i < frameEndInfo->layerCount; i++)
+            {
+                if (XR_TYPE_COMPOSITION_LAYER_PROJECTION != frameEndInfo->layers[i]->type)
+                {
+                    continue;
+                }
+                const XrCompositionLayerProjection* projectionLayer =
+                    reinterpret_cast<const XrCompositionLayerProjection*>(frameEndInfo->layers[i]);
+                XrPosef basePose;
+                if (!GetSpacePose(projectionLayer->space, frameEndInfo->displayTime, basePose))
+                {
+                    return XR_ERROR_HANDLE_INVALID;
+                }
+                submission.viewCount = std::min(projectionLayer->viewCount, ViewCount);
+                for (uint32_t j = 0; j < submission.viewCount; j++)
+                {
+                    submission.poses[j] = Pose::Multiply(projectionLayer->views[j].pose, basePose);
+                }
+            }
+            return XR_SUCCESS;
+        }
+
+        // swapchains are not supported without graphics
+
+        XrResult XRAPI_CALL xrEnumerateSwapchainFormats(XrSession session,
+                                                        uint32_t formatCapacityInput,
+                                                        uint32_t* formatCountOutput,
+                                                        int64_t* formats)
+        {
+            *formatCountOutput = 0;
+            return XR_SUCCESS;
+        }
+
+        XrResult XRAPI_CALL xrCreateSwapchain(XrSession session,
+                                              const XrSwapchainCreateInfo* createInfo,
+                                              XrSwapchain* swapchain)
+        {
+            return XR_ERROR_SWAPCHAIN_FORMAT_UNSUPPORTED;
+        }
+
+        XrResult XRAPI_CALL xrDestroySwapchain(XrSwapchain swapchain)
+        {
+            return XR_ERROR_HANDLE_INVALID;
+        }
+
+        XrResult XRAPI_CALL xrEnumerateSwapchainImages(XrSwapchain swapchain,
+                                                       uint32_t imageCapacityInput,
+                                                       uint32_t* imageCountOutput,
+                                                       XrSwapchainImageBaseHeader* images)
+        {
+            return XR_ERROR_HANDLE_INVALID;
+        }
+
+        XrResult XRAPI_CALL xrAcquireSwapchainImage(XrSwapchain swapchain,
+                                                    const XrSwapchainImageAcquireInfo* acquireInfo,
+                                                    uint32_t* index)
+        {
+            return XR_ERROR_HANDLE_INVALID;
+        }
+
+        XrResult XRAPI_CALL xrWaitSwapchainImage(XrSwapchain swapchain, const XrSwapchainImageWaitInfo* waitInfo)
+        {
+            return XR_ERROR_HANDLE_INVALID;
+        }
+
+        XrResult XRAPI_CALL xrReleaseSwapchainImage(XrSwapchain swapchain,
+                                                    const XrSwapchainImageReleaseInfo* releaseInfo)
+        {
+            return XR_ERROR_HANDLE_INVALID;
+        }
+
+        // counts the calls of a stub function without allocating, to be usable within measured frames
+        template <auto Function>
+        struct Counted;
+
+        template <typename... Args, XrResult(XRAPI_PTR* Function)(Args...)>
+        struct Counted<Function>
+        {
+            static XrResult XRAPI_CALL Call(Args... args)
+            {
+                calls++;
+                return Function(args...);
+            }
+
+            static inline std::atomic<uint64_t> calls{0};
+        };
+
+        struct Entry
+        {
+            PFN_xrVoidFunction function;
+            const std::atomic<uint64_t>* calls;
+        };
+
+#define STUB_FUNCTION(name) {#name, {reinterpret_cast<PFN_xrVoidFunction>(Counted<name>::Call), &Counted<name>::calls}}
+
+        const std::unordered_map<std::string, Entry> Functions{
+            STUB_FUNCTION(xrEnumerateInstanceExtensionProperties),
+            STUB_FUNCTION(xrDestroyInstance),
+            STUB_FUNCTION(xrGetInstanceProperties),
+            STUB_FUNCTION(xrGetSystem),
+            STUB_FUNCTION(xrGetSystemProperties),
+            STUB_FUNCTION(xrConvertWin32PerformanceCounterToTimeKHR),
+            STUB_FUNCTION(xrStringToPath),
+            STUB_FUNCTION(xrPathToString),
+            STUB_FUNCTION(xrCreateActionSet),
+            STUB_FUNCTION(xrDestroyActionSet),
+            STUB_FUNCTION(xrCreateAction),
+            STUB_FUNCTION(xrDestroyAction),
+            STUB_FUNCTION(xrSuggestInteractionProfileBindings),
+            STUB_FUNCTION(xrAttachSessionActionSets),
+            STUB_FUNCTION(xrGetCurrentInteractionProfile),
+            STUB_FUNCTION(xrSyncActions),
+            STUB_FUNCTION(xrGetActionStatePose),
+            STUB_FUNCTION(xrCreateSession),
+            STUB_FUNCTION(xrDestroySession),
+            STUB_FUNCTION(xrBeginSession),
+            STUB_FUNCTION(xrEndSession),
+            STUB_FUNCTION(xrCreateReferenceSpace),
+            STUB_FUNCTION(xrCreateActionSpace),
+            STUB_FUNCTION(xrDestroySpace),
+            STUB_FUNCTION(xrLocateSpace),
+            STUB_FUNCTION(xrLocateViews),
+            STUB_FUNCTION(xrWaitFrame),
+            STUB_FUNCTION(xrBeginFrame),
+            STUB_FUNCTION(xrEndFrame),
+            STUB_FUNCTION(xrEnumerateSwapchainFormats),
+            STUB_FUNCTION(xrCreateSwapchain),
+            STUB_FUNCTION(xrDestroySwapchain),
+            STUB_FUNCTION(xrEnumerateSwapchainImages),
+            STUB_FUNCTION(xrAcquireSwapchainImage),
+            STUB_FUNCTION(xrWaitSwapchainImage),
+            STUB_FUNCTION(xrReleaseSwapchainImage)};
+
+#undef STUB_FUNCTION
+    } // namespace
+
+    void SetMotion(const Motion& motion)
+    {
+        std::unique_lock lock(GetState().mutex);
+        GetState().motion = motion;
+    }
+
+    XrPosef GetEyePose(uint32_t eye, XrTime time)
+    {
+        return Pose::Multiply(GetEyeOffset(eye), GetViewPose(time));
+    }
+
+    XrPosef GetEyePoseOnRig(uint32_t eye, XrTime time)
+    {
+        return Pose::Multiply(GetEyeOffset(eye), GetHeadPoseOnRig(time));
+    }
+
+    XrPosef GetHeadPoseOnRig(XrTime time)
+    {
+        return GetState().motion.head(time);
+    }
+
+    uint64_t GetTrackerQueries()
+    {
+        return GetState().trackerQueries;
+    }
+
+    const Submission& GetLastSubmission()
+    {
+        return GetState().submission;
+    }
+
+    uint64_t GetCalls()
+    {
+        uint64_t calls{0};
+        for (const auto& [name, entry] : Functions)
+        {
+            calls += *entry.calls;
+        }
+        return calls;
+    }
+
+    uint64_t GetCalls(const std::string& function)
+    {
+        const auto entry = Functions.find(function);
+        return Functions.end() != entry ? entry->second.calls->load() : 0;
+    }
+
+    XrResult XRAPI_CALL GetInstanceProcAddr(XrInstance instance, const char* name, PFN_xrVoidFunction* function)
+    {
+        const auto entry = Functions.find(name);
+        if (Functions.end() == entry)
+        {
+            *function = nullptr;
+            return XR_ERROR_FUNCTION_UNSUPPORTED;
+        }
+        *function = entry->second.function;
+        return XR_SUCCESS;
+    }
+
+    XrResult XRAPI_CALL CreateApiLayerInstance(const XrInstanceCreateInfo* createInfo,
+                                               const XrApiLayerCreateInfo* apiLayerInfo,
+                                               XrInstance* instance)
+    {
+        *instance = NewHandle<XrInstance>();
+        return XR_SUCCESS;
+    }
+} // namespace Tests::StubRuntime
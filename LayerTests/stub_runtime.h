@@ -0,0 +1,56 @@
+// Copyright(c) 2022 Sebastian Veith
+
+#pragma once
+
+#include "pch.h"
+
+// minimal OpenXR runtime without headset or graphics, plugged into the layer as its next layer
+namespace Tests::StubRuntime
+{
+    constexpr XrTime FramePeriod{11111111}; // 90 Hz
+    constexpr uint32_t ViewCount{2};
+
+    // poses at display time: rig in local space, head relative to the rig and mount of the controller on the rig
+    struct Motion
+    {
+        std::function<XrPosef(XrTime)> rig;
+        std::function<XrPosef(XrTime)> head;
+        XrPosef controller{xr::math::Pose::Identity()};
+    };
+
+    // eye poses passed to the last xrEndFrame call
+    struct Submission
+    {
+        XrTime time{0};
+        uint32_t viewCount{0};
+        std::array<XrPosef, ViewCount> poses{};
+    };
+
+    void SetMotion(const Motion& motion);
+
+    // eye pose in local space, as rendered by the runtime
+    XrPosef GetEyePose(uint32_t eye, XrTime time);
+
+    // eye pose relative to the rig
+    XrPosef GetEyePoseOnRig(uint32_t eye, XrTime time);
+
+    // head pose relative to the rig
+    XrPosef GetHeadPoseOnRig(XrTime time);
+
+    // number of tracker pose queries, the layer starts querying on activation
+    uint64_t GetTrackerQueries();
+
+    const Submission& GetLastSubmission();
+
+    // number of calls of all runtime functions, from any thread
+    uint64_t GetCalls();
+
+    // number of calls of a single runtime function, from any thread
+    uint64_t GetCalls(const std::string& function);
+
+    // to be passed to xrCreateApiLayerInstance of the layer
+    XrResult XRAPI_CALL GetInstanceProcAddr(XrInstance instance, const char* name, PFN_xrVoidFunction* function);
+    XrResult XRAPI_CALL CreateApiLayerInstance(const XrInstanceCreateInfo* createInfo,
+                                               const XrApiLayerCreateInfo* apiLayerInfo,
+                                               XrInstance* instance);
+} // namespace Tests::StubRuntime
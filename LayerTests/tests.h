@@ -0,0 +1,32 @@
+// Copyright(c) 2022 Sebastian Veith
+
+#pragma once
+
+#include "pch.h"
+
+namespace Tests
+{
+    // ini values written to the application config of the tests, on top of the default configuration
+    using ConfigOverrides = std::vector<std::tuple<std::string, std::string, std::string>>;
+
+    // points the layer to a temporary config directory and loads the configuration for the given application
+    bool InitConfig(const std::string& application, const ConfigOverrides& overrides);
+
+    // concurrent pose delta requests need to receive consistent snapshots
+    bool SnapshotStressTest();
+
+    // runs synthetic frames through the layer on top of a stub runtime, reports frame cost, allocations and pose error
+    bool Benchmark();
+
+    // cost of tracing a pose with and without an enabled trace session
+    bool TracingBenchmark();
+
+    // parser of config files against the expected values and GetPrivateProfileString
+    bool IniFileTest();
+
+    // shortcut handling driven by an input script: press, repetition, reload while held and stale events
+    bool KeyboardTest();
+
+    // indexed marker mesh of the overlay against the triangle list it replaced
+    bool OverlayMeshTest();
+} // namespace Tests
@@ -0,0 +1,349 @@
+// Copyright(c) 2022 Sebastian Veith
+
+#include "pch.h"
+
+#include <conio.h>
+#include <deque>
+#include <log.h>
+#include <mmf.h>
+#include <recorder.h>
+
+namespace motion_compensation_layer::log
+{
+    // required by the layer's logging, output only goes to the debugger here
+    std::ofstream logStream;
+} // namespace motion_compensation_layer::log
+
+namespace
+{
+    struct Source
+    {
+        std::string label;
+        std::string name;
+        // raw size of the tracker data behind the optional mmf header
+        size_t size;
+    };
+
+    const std::vector<Source> Sources{{"yaw", utility::YawMmfName, 36},
+                                      {"srs", utility::SrsMmfName, 48},
+                                      {"flypt", utility::FlyPtMmfName, 48}};
+
+    // update statistics of a single mmf, kept for the last second
+    struct SourceState
+    {
+        const Source* source{nullptr};
+        utility::Mmf mmf;
+        std::vector<uint8_t> sample, previous;
+        utility::MmfHeader header{};
+        bool available{false}, extended{false};
+        uint64_t lastSequence{0};
+        int64_t lastUpdate{0};
+        uint64_t updates{0};
+        std::deque<int64_t> window;
+    };
+
+    constexpr int64_t SecondNs{1000000000};
+    const std::chrono::milliseconds SampleInterval{1};
+    const std::chrono::milliseconds DisplayInterval{250};
+
+    std::atomic_bool g_Stop{false};
+
+    int64_t QpcToNs(int64_t qpc)
+    {
+        static const int64_t frequency = [] {
+            LARGE_INTEGER value;
+            QueryPerformanceFrequency(&value);
+            return value.QuadPart;
+        }();
+        return (qpc / frequency) * SecondNs + (qpc % frequency) * SecondNs / frequency;
+    }
+
+    int64_t Now()
+    {
+        LARGE_INTEGER counter;
+        QueryPerformanceCounter(&counter);
+        return QpcToNs(counter.QuadPart);
+    }
+
+    BOOL WINAPI OnConsoleCtrl(DWORD type)
+    {
+        g_Stop = true;
+        return TRUE;
+    }
+
+    // writes updates in the format of the layer's pose recorder, decode with scripts/decode_pose_trace.py
+    class TraceWriter
+    {
+      public:
+        ~TraceWriter()
+        {
+            Close();
+        }
+
+        bool Open(const std::string& fileName)
+        {
+            m_File.open(fileName, std::ios::binary | std::ios::trunc);
+            if (!m_File.is_open())
+            {
+                return false;
+            }
+            WriteHeader();
+            return true;
+        }
+
+        void Write(int64_t time, uint64_t sequence, const std::vector<uint8_t>& sample)
+        {
+            if (!m_File.is_open())
+            {
+                return;
+            }
+            Recorder::TraceRecord record{};
+            record.type = Recorder::RecordType::Sample;
+            record.sampleSize = (uint32_t)std::min(sample.size(), sizeof(record.sample));
+            record.time = time;
+            record.sequence = sequence;
+            record.pose = xr::math::Pose::Identity();
+            record.delta = xr::math::Pose::Identity();
+            memcpy(record.sample, sample.data(), record.sampleSize);
+            m_File.write(reinterpret_cast<const char*>(&record), sizeof(record));
+            m_Count++;
+        }
+
+        void Close()
+        {
+            if (m_File.is_open())
+            {
+                // records are written in order, so the whole file is a single ring buffer pass
+                m_File.seekp(0);
+                WriteHeader();
+                m_File.close();
+            }
+        }
+
+        int64_t GetCount() const
+        {
+            return m_Count;
+        }
+
+      private:
+        void WriteHeader()
+        {
+            const Recorder::TraceFileHeader header{Recorder::TraceMagic,
+                                                   Recorder::TraceVersion,
+                                                   sizeof(Recorder::TraceRecord),
+                                                   (uint32_t)m_Count,
+                                                   m_Count,
+                                                   {}};
+            m_File.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        }
+
+        std::ofstream m_File;
+        int64_t m_Count{0};
+    };
+
+    void Sample(SourceState& state, TraceWriter& trace, int64_t now)
+    {
+        utility::MmfHeader header{};
+        state.available = state.mmf.Read(state.sample.data(), state.sample.size(), now, &header);
+        if (!state.available)
+        {
+            return;
+        }
+        state.extended = utility::MmfMagic == header.magic;
+
+        // timestamped samples are detected by sequence, legacy samples by content
+        bool updated{false};
+        int64_t updateTime{now};
+        if (state.extended)
+        {
+            updated = header.sequence != state.lastSequence;
+            updateTime = QpcToNs(header.qpcTime);
+        }
+        else
+        {
+            updated = state.sample != state.previous;
+        }
+        state.header = header;
+        if (!updated)
+        {
+            return;
+        }
+        state.previous = state.sample;
+        state.lastSequence = header.sequence;
+        state.lastUpdate = updateTime;
+        state.updates++;
+        state.window.push_back(updateTime);
+        trace.Write(updateTime, state.extended ? header.sequence : state.updates, state.sample);
+    }
+
+    void PrintStatistics(std::vector<SourceState>& states, int64_t now, const TraceWriter& trace)
+    {
+        // overwrite previous output instead of scrolling
+        const HANDLE console = GetStdHandle(STD_OUTPUT_HANDLE);
+        SetConsoleCursorPosition(console, {0, 0});
+
+        std::stringstream output;
+        output << "OpenXR-MotionCompensation mmf inspector - press 'q' or escape to quit\n\n";
+        output << fmt::format("{:<7}{:<11}{:>10}{:>11}{:>11}{:>14}{:>8}{:>10}{:>12}\n",
+                              "source",
+                              "protocol",
+                              "rate (Hz)",
+                              "mean (ms)",
+                              "jitter (ms)",
+                              "staleness (ms)",
+                              "torn",
+                              "updates",
+                              "sequence");
+        for (auto& state : states)
+        {
+            while (!state.window.empty() && state.window.front() < now - SecondNs)
+            {
+                state.window.pop_front();
+            }
+            if (!state.available)
+            {
+                output << fmt::format("{:<7}{:<11}{:<86}\n", state.source->label, "-", "not available");
+                continue;
+            }
+
+            double mean{0.0}, jitter{0.0};
+            if (state.window.size() > 1)
+            {
+                std::vector<double> intervals;
+                for (size_t i = 1; i < state.window.size(); i++)
+                {
+                    intervals.push_back((state.window[i] - state.window[i - 1]) / 1000000.0);
+                }
+                for (const double interval : intervals)
+                {
+                    mean += interval;
+                }
+                mean /= intervals.size();
+                for (const double interval : intervals)
+                {
+                    jitter += (interval - mean) * (interval - mean);
+                }
+                jitter = sqrt(jitter / intervals.size());
+            }
+            output << fmt::format("{:<7}{:<11}{:>10}{:>11.3f}{:>11.3f}{:>14.3f}{:>8}{:>10}{:>12}\n",
+                                  state.source->label,
+                                  state.extended ? "timestamp" : "legacy",
+                                  state.window.size(),
+                                  mean,
+                                  jitter,
+                                  state.lastUpdate ? (now - state.lastUpdate) / 1000000.0 : 0.0,
+                                  state.mmf.GetTornReads(),
+                                  state.updates,
+                                  state.extended ? std::to_string(state.header.sequence) : "-");
+        }
+        if (trace.GetCount())
+        {
+            output << fmt::format("\n{} updates recorded\n", trace.GetCount());
+        }
+        std::cout << output.str() << std::flush;
+    }
+
+    void PrintUsage()
+    {
+        std::cout << "usage: MmfInspector [--source yaw|srs|flypt] [--duration <seconds>] [--trace <file>]\n"
+                     "  --source    inspect a single mmf instead of all of them\n"
+                     "  --duration  stop after the given time\n"
+                     "  --trace     record all updates, convert to csv with scripts/decode_pose_trace.py\n";
+    }
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    std::string source, traceFile;
+    double duration{0.0};
+    for (int i = 1; i < argc; i++)
+    {
+        const std::string arg(argv[i]);
+        if ("--source" == arg && i + 1 < argc)
+        {
+            source = argv[++i];
+        }
+        else if ("--duration" == arg && i + 1 < argc)
+        {
+            duration = atof(argv[++i]);
+        }
+        else if ("--trace" == arg && i + 1 < argc)
+        {
+            traceFile = argv[++i];
+        }
+        else
+        {
+            PrintUsage();
+            return 1;
+        }
+    }
+
+    std::vector<SourceState> states(source.empty() ? Sources.size() : 1);
+    size_t index{0};
+    for (const auto& candidate : Sources)
+    {
+        if (!source.empty() && source != candidate.label)
+        {
+            continue;
+        }
+        SourceState& state = states[index++];
+        state.source = &candidate;
+        state.mmf.SetName(candidate.name);
+        state.sample.resize(candidate.size);
+    }
+    if (index != states.size())
+    {
+        std::cout << "unknown source: " << source << "\n";
+        PrintUsage();
+        return 1;
+    }
+
+    TraceWriter trace;
+    if (!traceFile.empty() && !trace.Open(traceFile))
+    {
+        std::cout << "unable to create trace file: " << traceFile << "\n";
+        return 1;
+    }
+
+    SetConsoleCtrlHandler(OnConsoleCtrl, TRUE);
+    system("cls");
+
+    // sleep granularity of 1 ms is required to sample at 1 kHz
+    timeBeginPeriod(1);
+    const int64_t start = Now();
+    int64_t nextDisplay{start};
+    while (!g_Stop)
+    {
+        const int64_t now = Now();
+        for (auto& state : states)
+        {
+            Sample(state, trace, now);
+        }
+        if (now >= nextDisplay)
+        {
+            nextDisplay = now + std::chrono::nanoseconds(DisplayInterval).count();
+            PrintStatistics(states, now, trace);
+            while (_kbhit())
+            {
+                const int key = _getch();
+                if ('q' == key || 'Q' == key || 27 == key)
+                {
+                    g_Stop = true;
+                }
+            }
+        }
+        if (duration > 0.0 && now - start >= (int64_t)(duration * SecondNs))
+        {
+            g_Stop = true;
+        }
+        std::this_thread::sleep_for(SampleInterval);
+    }
+    timeEndPeriod(1);
+
+    trace.Close();
+    for (auto& state : states)
+    {
+        state.mmf.Close();
+    }
+    return 0;
+}
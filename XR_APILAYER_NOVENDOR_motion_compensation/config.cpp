@@ -12,6 +12,12 @@
 using namespace motion_compensation_layer::log;
 using namespace utility;
 
+ConfigManager::~ConfigManager()
+{
+    StopWatcher();
+    StopWriter();
+}
+
 bool ConfigManager::Init(const std::string& application)
 {
     // create application config file if not existing
@@ -20,6 +26,7 @@ bool ConfigManager::Init(const std::string& application)
     {
         ErrorLog("unable to find internal enable entry\n");
     }
+    m_Application = application;
     m_ApplicationIni = motion_compensation_layer::localAppData.string() + "\\" + application + ".ini";
     if ((_access(m_ApplicationIni.c_str(), 0)) == -1)
     {
@@ -36,178 +43,298 @@ bool ConfigManager::Init(const std::string& application)
                      LastErrorMsg().c_str());
         }
     }
-    const std::string coreIni(motion_compensation_layer::localAppData.string() + "\\" + "OpenXR-MotionCompensation.ini");
-    if ((_access(coreIni.c_str(), 0)) != -1)
-    {
-        // check global deactivation flag
-        char buffer[2048];
-        if (0 < GetPrivateProfileString(enabledKey->second.first.c_str(),
-                                        enabledKey->second.second.c_str(),
-                                        NULL,
-                                        buffer,
-                                        2047,
-                                        coreIni.c_str()) &&
-            std::string(buffer) != "1")
-        {
-            m_Values[Cfg::Enabled] = buffer;
-            Log("motion compensation disabled globally\n");
-            return true;
-        }
+    // values are parsed completely before replacing the ones in use
+    Values values{};
+    const bool success = ReadFiles(values);
+    std::unique_lock lock(m_ValuesMutex);
+    m_Values = values;
+    m_FileValues = std::move(values);
+    return success;
+}
 
-        std::string errors;
-        for (const auto& entry : m_Keys)
+bool ConfigManager::ReadFiles(Values& values) const
+{
+    const std::string coreIniPath(motion_compensation_layer::localAppData.string() + "\\" +
+                                  "OpenXR-MotionCompensation.ini");
+    // read both files once instead of querying each key separately
+    utility::IniFile coreIni, appIni;
+    if (!coreIni.Load(coreIniPath))
+    {
+        ErrorLog("%s: unable to find config file %s\n", __FUNCTION__, coreIniPath.c_str());
+        return false;
+    }
+
+    // check global deactivation flag
+    const auto& enabledKey = m_Keys.find(Cfg::Enabled);
+    std::string enabled, error;
+    if (coreIni.Get(enabledKey->second.first, enabledKey->second.second, enabled) && "1" != enabled)
+    {
+        ParseValue(Cfg::Enabled, enabled, values[(size_t)Cfg::Enabled], error);
+        Log("motion compensation disabled globally\n");
+        return true;
+    }
+
+    if (!appIni.Load(m_ApplicationIni))
+    {
+        ErrorLog("%s: unable to read %s, using values of %s\n",
+                 __FUNCTION__,
+                 m_ApplicationIni.c_str(),
+                 coreIniPath.c_str());
+    }
+    std::string errors, invalidValues;
+    for (const auto& entry : m_Keys)
+    {
+        // application specific values take precedence
+        std::string value;
+        if (appIni.Get(entry.second.first, entry.second.second, value) ||
+            coreIni.Get(entry.second.first, entry.second.second, value))
         {
-            
-            if (0 < GetPrivateProfileString(entry.second.first.c_str(),
-                                            entry.second.second.c_str(),
-                                            NULL,
-                                            buffer,
-                                            2047,
-                                            m_ApplicationIni.c_str()))
+            if (!ParseValue(entry.first, value, values[(size_t)entry.first], error))
             {
-                m_Values[entry.first] = buffer;
+                invalidValues += error;
             }
-            else if ((0 < GetPrivateProfileString(entry.second.first.c_str(),
-                                                  entry.second.second.c_str(),
-                                                  NULL,
-                                                  buffer,
-                                                  2047,
-                                                  coreIni.c_str())))
-            {
-                m_Values[entry.first] = buffer;
-            }
-            else
-            {
-                errors += "unable to read key: " + entry.second.second + " in section " + entry.second.first +
-                          ", error: " + LastErrorMsg();  
-            }      
         }
-        if (!errors.empty())
+        else
         {
-            ErrorLog("%s: unable to read configuration: %s\n", __FUNCTION__, errors.c_str());
-            return false;
+            errors += "unable to read key: " + entry.second.second + " in section " + entry.second.first + "\n";
         }
     }
-    else
+    if (!invalidValues.empty())
     {
-        ErrorLog("%s: unable to find config file %s\n", __FUNCTION__, coreIni.c_str());
+        // keys with invalid values can't be queried, affected features fall back to their defaults
+        ErrorLog("%s: invalid configuration values:\n%s", __FUNCTION__, invalidValues.c_str());
+    }
+    if (!errors.empty())
+    {
+        ErrorLog("%s: unable to read configuration:\n%s", __FUNCTION__, errors.c_str());
         return false;
     }
-    
     return true;
 }
 
-bool ConfigManager::GetBool(Cfg key, bool& val)
+bool ConfigManager::StartWatcher()
+{
+    if (m_Watcher.joinable())
+    {
+        return true;
+    }
+    m_StopWatcher = false;
+    m_FilesChanged = false;
+    m_Watcher = std::thread(&ConfigManager::Watch, this);
+    return true;
+}
+
+void ConfigManager::StopWatcher()
+{
+    if (m_Watcher.joinable())
+    {
+        m_StopWatcher = true;
+        m_Watcher.join();
+    }
+}
+
+bool ConfigManager::ReloadChanges(std::set<Cfg>& changed)
 {
-    std::string strVal;
-    if (GetString(key, strVal))
+    // wait until writing of the files is finished
+    if (!m_FilesChanged || GetTickCount64() - m_LastChange < m_ChangeDelay)
     {
-        try
+        return false;
+    }
+    m_FilesChanged = false;
+    Values values{};
+    const Value& enabled = values[(size_t)Cfg::Enabled];
+    if (!ReadFiles(values) || !enabled.isNumber || !enabled.intVal)
+    {
+        ErrorLog("%s: unable to apply modified configuration files, keeping previous values\n", __FUNCTION__);
+        return false;
+    }
+    std::unique_lock lock(m_ValuesMutex);
+    for (size_t i = 0; i < values.size(); i++)
+    {
+        // keep values modified by shortcut unless the key was modified in the files as well
+        if (IsEqual(m_FileValues[i], values[i]))
         {
-            val = stoi(strVal);
-            return true;
+            continue;
         }
-        catch (std::exception e)
+        if (!IsEqual(m_Values[i], values[i]))
         {
-            ErrorLog("%s: unable to convert value (%s) for key (%s) to integer: %s\n",
-                     __FUNCTION__,
-                     strVal.c_str(),
-                     m_Keys[key].first,
-                     e.what());
-        } 
+            changed.insert((Cfg)i);
+        }
+        m_Values[i] = values[i];
     }
-    return false;
+    m_FileValues = std::move(values);
+    Log("configuration files modified, %zu value(s) changed\n", changed.size());
+    return true;
 }
-bool ConfigManager::GetInt(Cfg key, int& val)
+
+bool ConfigManager::IsEqual(const Value& a, const Value& b)
 {
-    std::string strVal;
-    if (GetString(key, strVal))
+    // compare numbers by value to ignore different formatting
+    return a.isNumber && b.isNumber ? a.floatVal == b.floatVal && a.intVal == b.intVal
+                                    : a.isSet == b.isSet && a.string == b.string;
+}
+
+void ConfigManager::Watch()
+{
+    const std::wstring coreIni(L"OpenXR-MotionCompensation.ini");
+    const std::wstring appIni(std::filesystem::path(m_ApplicationIni).filename().wstring());
+    HANDLE directory = CreateFileW(motion_compensation_layer::localAppData.wstring().c_str(),
+                                   FILE_LIST_DIRECTORY,
+                                   FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                                   nullptr,
+                                   OPEN_EXISTING,
+                                   FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED,
+                                   nullptr);
+    if (INVALID_HANDLE_VALUE == directory)
     {
-        try
+        ErrorLog("%s: unable to watch %s: %s\n",
+                 __FUNCTION__,
+                 motion_compensation_layer::localAppData.string().c_str(),
+                 LastErrorMsg().c_str());
+        return;
+    }
+    OVERLAPPED overlapped{};
+    overlapped.hEvent = CreateEvent(nullptr, TRUE, FALSE, nullptr);
+    alignas(DWORD) char buffer[4096];
+    bool pending{false};
+    while (!m_StopWatcher)
+    {
+        if (!pending)
         {
-            val = stoi(strVal);
-            return true;
+            if (!ReadDirectoryChangesW(directory,
+                                       buffer,
+                                       sizeof(buffer),
+                                       FALSE,
+                                       FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_FILE_NAME,
+                                       nullptr,
+                                       &overlapped,
+                                       nullptr))
+            {
+                ErrorLog("%s: unable to read directory changes: %s\n", __FUNCTION__, LastErrorMsg().c_str());
+                break;
+            }
+            pending = true;
         }
-        catch (std::exception e)
+        // time out periodically to allow for shutdown
+        const DWORD result = WaitForSingleObject(overlapped.hEvent, 100);
+        if (WAIT_TIMEOUT == result)
         {
-            ErrorLog("%s: unable to convert value (%s) for key (%s) to integer: %s\n",
-                     __FUNCTION__,
-                     strVal.c_str(),
-                     m_Keys[key].first.c_str(),
-                     e.what());
-        } 
+            continue;
+        }
+        pending = false;
+        DWORD bytes{0};
+        if (WAIT_OBJECT_0 != result || !GetOverlappedResult(directory, &overlapped, &bytes, FALSE))
+        {
+            ErrorLog("%s: waiting for directory changes failed: %s\n", __FUNCTION__, LastErrorMsg().c_str());
+            break;
+        }
+        ResetEvent(overlapped.hEvent);
+
+        // buffer overflow is reported with zero bytes, files might have been modified in that case
+        bool modified = 0 == bytes;
+        for (DWORD offset = 0; bytes && !modified;)
+        {
+            const auto info = reinterpret_cast<const FILE_NOTIFY_INFORMATION*>(buffer + offset);
+            const std::wstring fileName(info->FileName, info->FileNameLength / sizeof(WCHAR));
+            modified = 0 == _wcsicmp(fileName.c_str(), coreIni.c_str()) ||
+                       0 == _wcsicmp(fileName.c_str(), appIni.c_str());
+            if (!info->NextEntryOffset)
+            {
+                break;
+            }
+            offset += info->NextEntryOffset;
+        }
+        if (modified)
+        {
+            m_LastChange = GetTickCount64();
+            m_FilesChanged = true;
+        }
     }
-    return false;
+    if (pending)
+    {
+        CancelIoEx(directory, &overlapped);
+        DWORD bytes;
+        GetOverlappedResult(directory, &overlapped, &bytes, TRUE);
+    }
+    CloseHandle(overlapped.hEvent);
+    CloseHandle(directory);
+}
+
+bool ConfigManager::GetBool(Cfg key, bool& val)
+{
+    std::unique_lock lock(m_ValuesMutex);
+    const Value& value = m_Values[(size_t)key];
+    if (!value.isNumber)
+    {
+        return false;
+    }
+    val = value.intVal;
+    return true;
+}
+bool ConfigManager::GetInt(Cfg key, int& val)
+{
+    std::unique_lock lock(m_ValuesMutex);
+    const Value& value = m_Values[(size_t)key];
+    if (!value.isNumber)
+    {
+        return false;
+    }
+    val = value.intVal;
+    return true;
 }
 bool ConfigManager::GetFloat(Cfg key, float& val)
 {
-    std::string strVal;
-    if (GetString(key, strVal))
+    std::unique_lock lock(m_ValuesMutex);
+    const Value& value = m_Values[(size_t)key];
+    if (!value.isNumber)
     {
-        try
-        {
-            val = stof(strVal);
-            return true;
-        }
-        catch (std::exception e)
-        {
-            ErrorLog("%s: unable to convert value (%s) for key (%s) to double: %s\n",
-                     __FUNCTION__,
-                     strVal.c_str(),
-                     m_Keys[key].first.c_str(),
-                     e.what());
-            return false;
-        } 
+        return false;
     }
-    return false;
+    val = value.floatVal;
+    return true;
 }
 bool ConfigManager::GetString(Cfg key, std::string& val)
 {
-    const auto it = m_Values.find(key);
-    if (m_Values.end() == it)
+    std::unique_lock lock(m_ValuesMutex);
+    const Value& value = m_Values[(size_t)key];
+    if (!value.isSet)
     {
-        ErrorLog("%s: unable to find value for key: [%s] %s \n",
-                 __FUNCTION__,
-                 m_Keys[key].first.c_str(), m_Keys[key].second.c_str());
         return false;
     }
-    val = it->second;
+    val = value.string;
     return true;
 }
 bool ConfigManager::GetShortcut(Cfg key, std::set<int>& val)
 {
-    std::string strVal, remaining, errors;
-    if (GetString(key, strVal))
+    std::unique_lock lock(m_ValuesMutex);
+    const Value& value = m_Values[(size_t)key];
+    if (value.shortcut.empty())
     {
-        size_t separator;
-        remaining = strVal;
-        do
-        {
-            separator = remaining.find_first_of("+");
-            const std::string key = remaining.substr(0, separator);
-            auto it = m_ShortCuts.find(key);
-            if (it == m_ShortCuts.end())
-            {
-                errors += "unable to find virtual key number for: " + key + "\n";
-            }
-            else
-            {
-                val.insert(it->second);
-            }
-            remaining.erase(0, separator + 1);
-        } while (std::string::npos != separator);
-    }
-    if (!errors.empty())
-    {
-        ErrorLog("%s: unable to convert value (%s) for key (%s) to shortcut:\n%s",
-                 __FUNCTION__,
-                 strVal.c_str(),
-                 m_Keys[key].first.c_str(),
-                 errors.c_str());
         return false;
     }
+    val.insert(value.shortcut.cbegin(), value.shortcut.cend());
     return true;
 }
+bool ConfigManager::GetVirtualKeys(const std::string& combination, std::set<int>& val, std::string& errors) const
+{
+    size_t begin{0}, separator;
+    do
+    {
+        separator = combination.find_first_of("+", begin);
+        const std::string keyName = combination.substr(begin, separator - begin);
+        auto it = m_ShortCuts.find(keyName);
+        if (it == m_ShortCuts.end())
+        {
+            errors += " " + keyName;
+        }
+        else
+        {
+            val.insert(it->second);
+        }
+        begin = separator + 1;
+    } while (std::string::npos != separator);
+    return errors.empty();
+}
 std::string ConfigManager::GetControllerSide()
 {
     std::string side{"left"};
@@ -225,19 +352,85 @@ std::string ConfigManager::GetControllerSide()
 
 void ConfigManager::SetValue(Cfg key, bool val)
 {
-    SetValue(key, std::to_string(val));
+    SetValue(key, (int)val);
 }
 void ConfigManager::SetValue(Cfg key, int val)
 {
-    SetValue(key, std::to_string(val));
+    std::unique_lock lock(m_ValuesMutex);
+    Value& value = m_Values[(size_t)key];
+    value.isSet = value.isNumber = true;
+    value.intVal = val;
+    value.floatVal = (float)val;
+    value.string = std::to_string(val);
 }
 void ConfigManager::SetValue(Cfg key, float val)
 {
-    SetValue(key, std::to_string(val));
+    std::unique_lock lock(m_ValuesMutex);
+    Value& value = m_Values[(size_t)key];
+    value.isSet = value.isNumber = true;
+    value.intVal = (int)val;
+    value.floatVal = val;
+    value.string = std::to_string(val);
 }
 void ConfigManager::SetValue(Cfg key, const std::string& val)
 {
-    m_Values[key] = val;
+    std::string error;
+    Value value;
+    if (!ParseValue(key, val, value, error))
+    {
+        ErrorLog("%s: %s", __FUNCTION__, error.c_str());
+    }
+    std::unique_lock lock(m_ValuesMutex);
+    m_Values[(size_t)key] = std::move(value);
+}
+
+bool ConfigManager::ParseValue(Cfg key, const std::string& val, Value& value, std::string& error) const
+{
+    const auto& keyEntry = m_Keys.find(key);
+    if (m_Keys.end() == keyEntry)
+    {
+        error = "key not found in key map: " + std::to_string((int)key) + "\n";
+        return false;
+    }
+    value = Value{};
+    value.isSet = true;
+    value.string = val;
+    if (m_StringKeys.contains(key))
+    {
+        return true;
+    }
+    const std::string name = "[" + keyEntry->second.first + "] " + keyEntry->second.second;
+    if ("shortcuts" == keyEntry->second.first)
+    {
+        std::string errors;
+        if (!GetVirtualKeys(val, value.shortcut, errors))
+        {
+            value.shortcut.clear();
+            error = name + " = " + val + ": unable to find virtual key number for:" + errors + "\n";
+            return false;
+        }
+        return true;
+    }
+
+    // same leniency as stoi/stof: leading plus sign and trailing characters are accepted
+    const char* begin = val.c_str();
+    const char* end = begin + val.size();
+    if (begin != end && '+' == *begin)
+    {
+        begin++;
+    }
+    if (std::from_chars(begin, end, value.floatVal).ec != std::errc())
+    {
+        error = name + " = " + val + ": unable to convert to number\n";
+        return false;
+    }
+    if (std::from_chars(begin, end, value.intVal).ec != std::errc())
+    {
+        // e.g. ".5"
+        value.intVal = (int)value.floatVal;
+    }
+    value.isNumber = true;
+    return true;
 }
 
 void ConfigManager::WriteConfig(bool forApp)
@@ -246,30 +439,17 @@ void ConfigManager::WriteConfig(bool forApp)
     const std::string configFile =
         forApp ? m_ApplicationIni
                : motion_compensation_layer::localAppData.string() + "\\" + "OpenXR-MotionCompensation.ini";
+    std::vector<IniEntry> entries;
+    std::unique_lock valuesLock(m_ValuesMutex);
     for (const auto key : m_KeysToSave)
     {
         const auto& keyEntry = m_Keys.find(key);
         if (m_Keys.end() != keyEntry)
         {
-            const auto& valueEntry = m_Values.find(key);
-            if (m_Values.end() != valueEntry)
+            const Value& value = m_Values[(size_t)key];
+            if (value.isSet)
             {
-                if (!WritePrivateProfileString(keyEntry->second.first.c_str(),
-                                               keyEntry->second.second.c_str(),
-                                               valueEntry->second.c_str(),
-                                               configFile.c_str()) &&
-                    2 != GetLastError())
-                {
-                    error = true;
-                    DWORD err = GetLastError();
-                    ErrorLog("%s: unable to write value %s into key %s to section %s in %s, error: %s\n",
-                             __FUNCTION__,
-                             valueEntry->second.c_str(),
-                             keyEntry->second.second.c_str(),
-                             keyEntry->second.first.c_str(),
-                             configFile.c_str(),
-                             LastErrorMsg().c_str());
-                }
+                entries.push_back({keyEntry->second.first, keyEntry->second.second, value.string});
             }
             else
             {
@@ -286,8 +466,168 @@ void ConfigManager::WriteConfig(bool forApp)
             ErrorLog("%s: key not found in key map: %d\n", __FUNCTION__, key);
         }
     }
-    Log("current configuration %ssaved to %s\n", error ? "could not be " : "", m_ApplicationIni.c_str());
-    GetAudioOut()->Execute(!error ? Feedback::Event::Save : Feedback::Event::Error);
+    valuesLock.unlock();
+    if (error)
+    {
+        Log("current configuration could not be saved to %s\n", configFile.c_str());
+        GetAudioOut()->Execute(Feedback::Event::Error);
+        return;
+    }
+
+    // file is written on a separate thread to avoid stalling the frame
+    std::unique_lock lock(m_WriteMutex);
+    m_PendingWrites[configFile] = std::move(entries);
+    if (!m_Writer.joinable())
+    {
+        m_StopWriter = false;
+        m_Writer = std::thread(&ConfigManager::Writer, this);
+    }
+    m_WriteSignal.notify_one();
+}
+
+void ConfigManager::StopWriter()
+{
+    {
+        std::unique_lock lock(m_WriteMutex);
+        m_StopWriter = true;
+        m_WriteSignal.notify_one();
+    }
+    if (m_Writer.joinable())
+    {
+        m_Writer.join();
+    }
+}
+
+void ConfigManager::Writer()
+{
+    std::unique_lock lock(m_WriteMutex);
+    while (true)
+    {
+        m_WriteSignal.wait(lock, [this] { return m_StopWriter || !m_PendingWrites.empty(); });
+        if (m_PendingWrites.empty())
+        {
+            // pending requests are written before stopping
+            return;
+        }
+        // collect requests arriving in quick succession
+        m_WriteSignal.wait_for(lock, 100ms, [this] { return m_StopWriter; });
+        const auto pendingWrites = std::exchange(m_PendingWrites, {});
+        lock.unlock();
+        for (const auto& [configFile, entries] : pendingWrites)
+        {
+            const bool success = SaveFile(configFile, entries);
+            Log("current configuration %ssaved to %s\n", success ? "" : "could not be ", configFile.c_str());
+            GetAudioOut()->Execute(success ? Feedback::Event::Save : Feedback::Event::Error);
+        }
+        lock.lock();
+    }
+}
+
+bool ConfigManager::SaveFile(const std::string& path, const std::vector<IniEntry>& entries)
+{
+    const auto lower = [](std::string text) {
+        std::transform(text.begin(), text.end(), text.begin(), [](unsigned char c) { return (char)tolower(c); });
+        return text;
+    };
+    const auto trim = [](const std::string& text) {
+        const size_t first = text.find_first_not_of(" \t");
+        return std::string::npos == first ? std::string()
+                                          : text.substr(first, text.find_last_not_of(" \t") - first + 1);
+    };
+
+    // entries not yet written by section
+    std::map<std::string, std::map<std::string, const IniEntry*>> remaining;
+    for (const auto& entry : entries)
+    {
+        remaining[lower(entry.section)][lower(entry.key)] = &entry;
+    }
+    const auto appendRemaining = [&remaining](const std::string& section, std::vector<std::string>& lines) {
+        const auto it = remaining.find(section);
+        if (remaining.end() == it)
+        {
+            return;
+        }
+        // insert behind the last entry of the section
+        auto position = lines.end();
+        while (position != lines.begin() && (position - 1)->find_first_not_of(" \t") == std::string::npos)
+        {
+            --position;
+        }
+        for (const auto& [key, entry] : it->second)
+        {
+            position = lines.insert(position, entry->key + " = " + entry->value) + 1;
+        }
+        remaining.erase(it);
+    };
+
+    // replace values in a single pass over the existing file, keeping comments and other entries
+    std::vector<std::string> lines;
+    std::ifstream input(path);
+    std::string line, section;
+    while (std::getline(input, line))
+    {
+        const std::string trimmed = trim(line);
+        if (!trimmed.empty() && '[' == trimmed[0])
+        {
+            appendRemaining(section, lines);
+            section = lower(trim(trimmed.substr(1, trimmed.find(']') - 1)));
+        }
+        else if (!trimmed.empty() && ';' != trimmed[0])
+        {
+            const size_t separator = trimmed.find('=');
+            const auto sectionEntries = remaining.find(section);
+            if (std::string::npos != separator && remaining.end() != sectionEntries)
+            {
+                const auto entry = sectionEntries->second.find(lower(trim(trimmed.substr(0, separator))));
+                if (sectionEntries->second.end() != entry)
+                {
+                    line = entry->second->key + " = " + entry->second->value;
+                    sectionEntries->second.erase(entry);
+                }
+            }
+        }
+        lines.push_back(line);
+    }
+    input.close();
+    appendRemaining(section, lines);
+    for (const auto& [name, sectionEntries] : remaining)
+    {
+        if (!sectionEntries.empty())
+        {
+            if (!lines.empty() && !trim(lines.back()).empty())
+            {
+                lines.push_back("");
+            }
+            lines.push_back("[" + sectionEntries.cbegin()->second->section + "]");
+            for (const auto& [key, entry] : sectionEntries)
+            {
+                lines.push_back(entry->key + " = " + entry->value);
+            }
+        }
+    }
+
+    // write to temporary file and replace the original to avoid leaving a partially written file
+    const std::string tempFile = path + ".tmp";
+    {
+        std::ofstream output(tempFile, std::ios::trunc);
+        for (const auto& outputLine : lines)
+        {
+            output << outputLine << "\n";
+        }
+        output.flush();
+        if (!output)
+        {
+            ErrorLog("%s: unable to write %s\n", __FUNCTION__, tempFile.c_str());
+            return false;
+        }
+    }
+    if (!MoveFileExA(tempFile.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH))
+    {
+        ErrorLog("%s: unable to replace %s: %s\n", __FUNCTION__, path.c_str(), LastErrorMsg().c_str());
+        DeleteFileA(tempFile.c_str());
+        return false;
+    }
+    return true;
 }
 
 std::unique_ptr<ConfigManager> g_config = nullptr;
@@ -13,6 +13,8 @@ enum class Cfg
     TrackerOffsetDown,
     TrackerOffsetRight,
     UseYawGeOffset,
+    CompositeRotation,
+    CompositeTranslation,
     CorX,
     CorY,
     CorZ,
@@ -47,18 +49,26 @@ enum class Cfg
     KeySaveConfigApp,
     KeyReloadConfig,
     KeyDebugCor,
-    TestRotation
+    TestRotation,
+    RecordPoses,
+    InputScript,
+    Count // number of keys, needs to stay last
 };
 
 class ConfigManager
 {
   public:
+    ~ConfigManager();
     bool Init(const std::string& application);
+    bool StartWatcher();
+    void StopWatcher();
+    bool ReloadChanges(std::set<Cfg>& changed);
     bool GetBool(Cfg key, bool& val);
     bool GetInt(Cfg key, int& val);
     bool GetFloat(Cfg key, float& val);
     bool GetString(Cfg key, std::string& val);
     bool GetShortcut(Cfg key, std::set<int>& val);
+    bool GetVirtualKeys(const std::string& combination, std::set<int>& val, std::string& errors) const;
     std::string GetControllerSide();
 
     void SetValue(Cfg key, bool val);
@@ -67,11 +77,52 @@ class ConfigManager
     void SetValue(Cfg key, const std::string& val);
 
     void WriteConfig(bool forApp);
+    void StopWriter();
 
   private:
+    // value parsed once when loaded or set
+    struct Value
+    {
+        bool isSet{false};
+        bool isNumber{false};
+        int intVal{0};
+        float floatVal{0.0f};
+        std::string string;
+        std::set<int> shortcut;
+    };
+    using Values = std::array<Value, (size_t)Cfg::Count>;
 
+    struct IniEntry
+    {
+        std::string section;
+        std::string key;
+        std::string value;
+    };
+
+    bool ReadFiles(Values& values) const;
+    bool ParseValue(Cfg key, const std::string& val, Value& value, std::string& error) const;
+    static bool IsEqual(const Value& a, const Value& b);
+    void Watch();
+    void Writer();
+    static bool SaveFile(const std::string& path, const std::vector<IniEntry>& entries);
+
+    std::string m_Application;
     std::string m_ApplicationIni;
 
+    // detection of config file modifications
+    std::thread m_Watcher;
+    std::atomic_bool m_StopWatcher{false};
+    std::atomic_bool m_FilesChanged{false};
+    std::atomic<uint64_t> m_LastChange{0};
+    const uint64_t m_ChangeDelay{250}; // ms without further modification before files are read
+
+    // asynchronous saving, requests for the same file are coalesced
+    std::thread m_Writer;
+    std::mutex m_WriteMutex;
+    std::condition_variable m_WriteSignal;
+    std::map<std::string, std::vector<IniEntry>> m_PendingWrites;
+    bool m_StopWriter{false};
+
     // needs to include all values of enum ConfigKey
     std::map<Cfg, std::pair<std::string, std::string>> m_Keys{
         {Cfg::Enabled, {"startup", "enabled"}},
@@ -89,6 +140,9 @@ class ConfigManager
 
         {Cfg::UseYawGeOffset, {"tracker", "use_yaw_ge_offset"}},
 
+        {Cfg::CompositeRotation, {"tracker", "composite_rotation"}},
+        {Cfg::CompositeTranslation, {"tracker", "composite_translation"}},
+
         {Cfg::CorX, {"tracker", "cor_x"}},
         {Cfg::CorY, {"tracker", "cor_y"}},
         {Cfg::CorZ, {"tracker", "cor_z"}},
@@ -134,7 +188,16 @@ class ConfigManager
         {Cfg::KeySaveConfigApp, {"shortcuts", "save_config_app"}},
         {Cfg::KeyReloadConfig, {"shortcuts", "reload_config"}},
 
-        {Cfg::TestRotation, {"debug", "testrotation"}}};
+        {Cfg::TestRotation, {"debug", "testrotation"}},
+        {Cfg::RecordPoses, {"debug", "record_poses"}},
+        {Cfg::InputScript, {"debug", "input_script"}}};
+
+    // keys in section shortcuts are parsed into virtual key codes, all others not listed here into numbers
+    std::set<Cfg> m_StringKeys{Cfg::TrackerType,
+                               Cfg::TrackerSide,
+                               Cfg::CompositeRotation,
+                               Cfg::CompositeTranslation,
+                               Cfg::InputScript};
 
     std::set<Cfg> m_KeysToSave{Cfg::TransStrength,
                                Cfg::RotStrength,
@@ -283,7 +346,12 @@ class ConfigManager
                                            {"GAMEPAD_RIGHT_THUMBSTICK_DOWN", VK_GAMEPAD_RIGHT_THUMBSTICK_DOWN},
                                            {"GAMEPAD_RIGHT_THUMBSTICK_RIGHT", VK_GAMEPAD_RIGHT_THUMBSTICK_RIGHT},
                                            {"GAMEPAD_RIGHT_THUMBSTICK_LEFT", VK_GAMEPAD_RIGHT_THUMBSTICK_LEFT}};
-    std::map<Cfg, std::string> m_Values{};
+
+    // values are replaced on the frame thread while other threads read them
+    std::mutex m_ValuesMutex;
+    Values m_Values{};
+    // content of the files at the last load, to detect keys modified in the files since then
+    Values m_FileValues{};
 };
 // Singleton accessor.
 ConfigManager* GetConfig();
\ No newline at end of file
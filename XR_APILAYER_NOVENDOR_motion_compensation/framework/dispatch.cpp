@@ -69,6 +69,9 @@ namespace LAYER_NAMESPACE {
 
         // request extension for usage of vive trackers
         implicitExtensions.push_back(XR_HTCX_VIVE_TRACKER_INTERACTION_EXTENSION_NAME);
+
+        // request extension for conversion of timestamps provided by virtual trackers
+        implicitExtensions.push_back(XR_KHR_WIN32_CONVERT_PERFORMANCE_COUNTER_TIME_EXTENSION_NAME);
  
         // Only request implicit extensions that are supported.
         //
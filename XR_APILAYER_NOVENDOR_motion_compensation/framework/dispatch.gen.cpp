@@ -135,6 +135,30 @@ namespace LAYER_NAMESPACE
 		return result;
 	}
 
+	XrResult xrCreateActionSpace(XrSession session, const XrActionSpaceCreateInfo* createInfo, XrSpace* space)
+	{
+		TraceLoggingWrite(g_traceProvider, "xrCreateActionSpace");
+
+		XrResult result;
+		try
+		{
+			result = LAYER_NAMESPACE::GetInstance()->xrCreateActionSpace(session, createInfo, space);
+		}
+		catch (std::exception exc)
+		{
+			TraceLoggingWrite(g_traceProvider, "xrCreateActionSpace_Error", TLArg(exc.what(), "Error"));
+			ErrorLog("xrCreateActionSpace: %s\n", exc.what());
+			result = XR_ERROR_RUNTIME_FAILURE;
+		}
+
+		TraceLoggingWrite(g_traceProvider, "xrCreateActionSpace_Result", TLArg(xr::ToCString(result), "Result"));
+		if (XR_FAILED(result)) {
+			ErrorLog("xrCreateActionSpace failed with %s\n", xr::ToCString(result));
+		}
+
+		return result;
+	}
+
 	XrResult xrLocateSpace(XrSpace space, XrSpace baseSpace, XrTime time, XrSpaceLocation* location)
 	{
 		TraceLoggingWrite(g_traceProvider, "xrLocateSpace");
@@ -159,6 +183,30 @@ namespace LAYER_NAMESPACE
 		return result;
 	}
 
+	XrResult xrDestroySpace(XrSpace space)
+	{
+		TraceLoggingWrite(g_traceProvider, "xrDestroySpace");
+
+		XrResult result;
+		try
+		{
+			result = LAYER_NAMESPACE::GetInstance()->xrDestroySpace(space);
+		}
+		catch (std::exception exc)
+		{
+			TraceLoggingWrite(g_traceProvider, "xrDestroySpace_Error", TLArg(exc.what(), "Error"));
+			ErrorLog("xrDestroySpace: %s\n", exc.what());
+			result = XR_ERROR_RUNTIME_FAILURE;
+		}
+
+		TraceLoggingWrite(g_traceProvider, "xrDestroySpace_Result", TLArg(xr::ToCString(result), "Result"));
+		if (XR_FAILED(result)) {
+			ErrorLog("xrDestroySpace failed with %s\n", xr::ToCString(result));
+		}
+
+		return result;
+	}
+
 	XrResult xrCreateSwapchain(XrSession session, const XrSwapchainCreateInfo* createInfo, XrSwapchain* swapchain)
 	{
 		TraceLoggingWrite(g_traceProvider, "xrCreateSwapchain");
@@ -327,6 +375,30 @@ namespace LAYER_NAMESPACE
 		return result;
 	}
 
+	XrResult xrWaitFrame(XrSession session, const XrFrameWaitInfo* frameWaitInfo, XrFrameState* frameState)
+	{
+		TraceLoggingWrite(g_traceProvider, "xrWaitFrame");
+
+		XrResult result;
+		try
+		{
+			result = LAYER_NAMESPACE::GetInstance()->xrWaitFrame(session, frameWaitInfo, frameState);
+		}
+		catch (std::exception exc)
+		{
+			TraceLoggingWrite(g_traceProvider, "xrWaitFrame_Error", TLArg(exc.what(), "Error"));
+			ErrorLog("xrWaitFrame: %s\n", exc.what());
+			result = XR_ERROR_RUNTIME_FAILURE;
+		}
+
+		TraceLoggingWrite(g_traceProvider, "xrWaitFrame_Result", TLArg(xr::ToCString(result), "Result"));
+		if (XR_FAILED(result)) {
+			ErrorLog("xrWaitFrame failed with %s\n", xr::ToCString(result));
+		}
+
+		return result;
+	}
+
 	XrResult xrEndFrame(XrSession session, const XrFrameEndInfo* frameEndInfo)
 	{
 		TraceLoggingWrite(g_traceProvider, "xrEndFrame");
@@ -487,92 +559,170 @@ namespace LAYER_NAMESPACE
 		else if (apiName == "xrGetSystem")
 		{
 			m_xrGetSystem = reinterpret_cast<PFN_xrGetSystem>(*function);
-			*function = reinterpret_cast<PFN_xrVoidFunction>(LAYER_NAMESPACE::xrGetSystem);
+			if (IsOverrideRequired(apiName))
+			{
+				*function = reinterpret_cast<PFN_xrVoidFunction>(LAYER_NAMESPACE::xrGetSystem);
+			}
 		}
 		else if (apiName == "xrCreateSession")
 		{
 			m_xrCreateSession = reinterpret_cast<PFN_xrCreateSession>(*function);
-			*function = reinterpret_cast<PFN_xrVoidFunction>(LAYER_NAMESPACE::xrCreateSession);
+			if (IsOverrideRequired(apiName))
+			{
+				*function = reinterpret_cast<PFN_xrVoidFunction>(LAYER_NAMESPACE::xrCreateSession);
+			}
 		}
 		else if (apiName == "xrDestroySession")
 		{
 			m_xrDestroySession = reinterpret_cast<PFN_xrDestroySession>(*function);
-			*function = reinterpret_cast<PFN_xrVoidFunction>(LAYER_NAMESPACE::xrDestroySession);
+			if (IsOverrideRequired(apiName))
+			{
+				*function = reinterpret_cast<PFN_xrVoidFunction>(LAYER_NAMESPACE::xrDestroySession);
+			}
 		}
 		else if (apiName == "xrCreateReferenceSpace")
 		{
 			m_xrCreateReferenceSpace = reinterpret_cast<PFN_xrCreateReferenceSpace>(*function);
-			*function = reinterpret_cast<PFN_xrVoidFunction>(LAYER_NAMESPACE::xrCreateReferenceSpace);
+			if (IsOverrideRequired(apiName))
+			{
+				*function = reinterpret_cast<PFN_xrVoidFunction>(LAYER_NAMESPACE::xrCreateReferenceSpace);
+			}
+		}
+		else if (apiName == "xrCreateActionSpace")
+		{
+			m_xrCreateActionSpace = reinterpret_cast<PFN_xrCreateActionSpace>(*function);
+			if (IsOverrideRequired(apiName))
+			{
+				*function = reinterpret_cast<PFN_xrVoidFunction>(LAYER_NAMESPACE::xrCreateActionSpace);
+			}
 		}
 		else if (apiName == "xrLocateSpace")
 		{
 			m_xrLocateSpace = reinterpret_cast<PFN_xrLocateSpace>(*function);
-			*function = reinterpret_cast<PFN_xrVoidFunction>(LAYER_NAMESPACE::xrLocateSpace);
+			if (IsOverrideRequired(apiName))
+			{
+				*function = reinterpret_cast<PFN_xrVoidFunction>(LAYER_NAMESPACE::xrLocateSpace);
+			}
+		}
+		else if (apiName == "xrDestroySpace")
+		{
+			m_xrDestroySpace = reinterpret_cast<PFN_xrDestroySpace>(*function);
+			if (IsOverrideRequired(apiName))
+			{
+				*function = reinterpret_cast<PFN_xrVoidFunction>(LAYER_NAMESPACE::xrDestroySpace);
+			}
 		}
 		else if (apiName == "xrCreateSwapchain")
 		{
 			m_xrCreateSwapchain = reinterpret_cast<PFN_xrCreateSwapchain>(*function);
-			*function = reinterpret_cast<PFN_xrVoidFunction>(LAYER_NAMESPACE::xrCreateSwapchain);
+			if (IsOverrideRequired(apiName))
+			{
+				*function = reinterpret_cast<PFN_xrVoidFunction>(LAYER_NAMESPACE::xrCreateSwapchain);
+			}
 		}
 		else if (apiName == "xrDestroySwapchain")
 		{
 			m_xrDestroySwapchain = reinterpret_cast<PFN_xrDestroySwapchain>(*function);
-			*function = reinterpret_cast<PFN_xrVoidFunction>(LAYER_NAMESPACE::xrDestroySwapchain);
+			if (IsOverrideRequired(apiName))
+			{
+				*function = reinterpret_cast<PFN_xrVoidFunction>(LAYER_NAMESPACE::xrDestroySwapchain);
+			}
 		}
 		else if (apiName == "xrAcquireSwapchainImage")
 		{
 			m_xrAcquireSwapchainImage = reinterpret_cast<PFN_xrAcquireSwapchainImage>(*function);
-			*function = reinterpret_cast<PFN_xrVoidFunction>(LAYER_NAMESPACE::xrAcquireSwapchainImage);
+			if (IsOverrideRequired(apiName))
+			{
+				*function = reinterpret_cast<PFN_xrVoidFunction>(LAYER_NAMESPACE::xrAcquireSwapchainImage);
+			}
 		}
 		else if (apiName == "xrWaitSwapchainImage")
 		{
 			m_xrWaitSwapchainImage = reinterpret_cast<PFN_xrWaitSwapchainImage>(*function);
-			*function = reinterpret_cast<PFN_xrVoidFunction>(LAYER_NAMESPACE::xrWaitSwapchainImage);
+			if (IsOverrideRequired(apiName))
+			{
+				*function = reinterpret_cast<PFN_xrVoidFunction>(LAYER_NAMESPACE::xrWaitSwapchainImage);
+			}
 		}
 		else if (apiName == "xrReleaseSwapchainImage")
 		{
 			m_xrReleaseSwapchainImage = reinterpret_cast<PFN_xrReleaseSwapchainImage>(*function);
-			*function = reinterpret_cast<PFN_xrVoidFunction>(LAYER_NAMESPACE::xrReleaseSwapchainImage);
+			if (IsOverrideRequired(apiName))
+			{
+				*function = reinterpret_cast<PFN_xrVoidFunction>(LAYER_NAMESPACE::xrReleaseSwapchainImage);
+			}
 		}
 		else if (apiName == "xrBeginSession")
 		{
 			m_xrBeginSession = reinterpret_cast<PFN_xrBeginSession>(*function);
-			*function = reinterpret_cast<PFN_xrVoidFunction>(LAYER_NAMESPACE::xrBeginSession);
+			if (IsOverrideRequired(apiName))
+			{
+				*function = reinterpret_cast<PFN_xrVoidFunction>(LAYER_NAMESPACE::xrBeginSession);
+			}
 		}
 		else if (apiName == "xrEndSession")
 		{
 			m_xrEndSession = reinterpret_cast<PFN_xrEndSession>(*function);
-			*function = reinterpret_cast<PFN_xrVoidFunction>(LAYER_NAMESPACE::xrEndSession);
+			if (IsOverrideRequired(apiName))
+			{
+				*function = reinterpret_cast<PFN_xrVoidFunction>(LAYER_NAMESPACE::xrEndSession);
+			}
+		}
+		else if (apiName == "xrWaitFrame")
+		{
+			m_xrWaitFrame = reinterpret_cast<PFN_xrWaitFrame>(*function);
+			if (IsOverrideRequired(apiName))
+			{
+				*function = reinterpret_cast<PFN_xrVoidFunction>(LAYER_NAMESPACE::xrWaitFrame);
+			}
 		}
 		else if (apiName == "xrEndFrame")
 		{
 			m_xrEndFrame = reinterpret_cast<PFN_xrEndFrame>(*function);
-			*function = reinterpret_cast<PFN_xrVoidFunction>(LAYER_NAMESPACE::xrEndFrame);
+			if (IsOverrideRequired(apiName))
+			{
+				*function = reinterpret_cast<PFN_xrVoidFunction>(LAYER_NAMESPACE::xrEndFrame);
+			}
 		}
 		else if (apiName == "xrLocateViews")
 		{
 			m_xrLocateViews = reinterpret_cast<PFN_xrLocateViews>(*function);
-			*function = reinterpret_cast<PFN_xrVoidFunction>(LAYER_NAMESPACE::xrLocateViews);
+			if (IsOverrideRequired(apiName))
+			{
+				*function = reinterpret_cast<PFN_xrVoidFunction>(LAYER_NAMESPACE::xrLocateViews);
+			}
 		}
 		else if (apiName == "xrSuggestInteractionProfileBindings")
 		{
 			m_xrSuggestInteractionProfileBindings = reinterpret_cast<PFN_xrSuggestInteractionProfileBindings>(*function);
-			*function = reinterpret_cast<PFN_xrVoidFunction>(LAYER_NAMESPACE::xrSuggestInteractionProfileBindings);
+			if (IsOverrideRequired(apiName))
+			{
+				*function = reinterpret_cast<PFN_xrVoidFunction>(LAYER_NAMESPACE::xrSuggestInteractionProfileBindings);
+			}
 		}
 		else if (apiName == "xrAttachSessionActionSets")
 		{
 			m_xrAttachSessionActionSets = reinterpret_cast<PFN_xrAttachSessionActionSets>(*function);
-			*function = reinterpret_cast<PFN_xrVoidFunction>(LAYER_NAMESPACE::xrAttachSessionActionSets);
+			if (IsOverrideRequired(apiName))
+			{
+				*function = reinterpret_cast<PFN_xrVoidFunction>(LAYER_NAMESPACE::xrAttachSessionActionSets);
+			}
 		}
 		else if (apiName == "xrGetCurrentInteractionProfile")
 		{
 			m_xrGetCurrentInteractionProfile = reinterpret_cast<PFN_xrGetCurrentInteractionProfile>(*function);
-			*function = reinterpret_cast<PFN_xrVoidFunction>(LAYER_NAMESPACE::xrGetCurrentInteractionProfile);
+			if (IsOverrideRequired(apiName))
+			{
+				*function = reinterpret_cast<PFN_xrVoidFunction>(LAYER_NAMESPACE::xrGetCurrentInteractionProfile);
+			}
 		}
 		else if (apiName == "xrSyncActions")
 		{
 			m_xrSyncActions = reinterpret_cast<PFN_xrSyncActions>(*function);
-			*function = reinterpret_cast<PFN_xrVoidFunction>(LAYER_NAMESPACE::xrSyncActions);
+			if (IsOverrideRequired(apiName))
+			{
+				*function = reinterpret_cast<PFN_xrVoidFunction>(LAYER_NAMESPACE::xrSyncActions);
+			}
 		}
 
 
@@ -638,6 +788,7 @@ namespace LAYER_NAMESPACE
 		{
 			throw new std::runtime_error("Failed to resolve xrGetActionStatePose");
 		}
+		m_xrGetInstanceProcAddr(m_instance, "xrConvertWin32PerformanceCounterToTimeKHR", reinterpret_cast<PFN_xrVoidFunction*>(&m_xrConvertWin32PerformanceCounterToTimeKHR));
 		m_applicationName = createInfo->applicationInfo.applicationName;
 		return XR_SUCCESS;
 	}
@@ -76,6 +76,12 @@ namespace LAYER_NAMESPACE
             return (bool)m_grantedExtensions.count(extensionName);
         }
 
+		// Overrides that aren't required hand out the next function pointer to avoid the indirection.
+		virtual bool IsOverrideRequired(const std::string& apiName) const
+		{
+			return true;
+		}
+
 		// Specially-handled by the auto-generated code.
 		virtual XrResult xrGetInstanceProcAddr(XrInstance instance, const char* name, PFN_xrVoidFunction* function);
 		virtual XrResult xrCreateInstance(const XrInstanceCreateInfo* createInfo);
@@ -235,6 +241,14 @@ namespace LAYER_NAMESPACE
 	private:
 		PFN_xrEndSession m_xrEndSession{ nullptr };
 
+	public:
+		virtual XrResult xrWaitFrame(XrSession session, const XrFrameWaitInfo* frameWaitInfo, XrFrameState* frameState)
+		{
+			return m_xrWaitFrame(session, frameWaitInfo, frameState);
+		}
+	private:
+		PFN_xrWaitFrame m_xrWaitFrame{ nullptr };
+
 	public:
 		virtual XrResult xrEndFrame(XrSession session, const XrFrameEndInfo* frameEndInfo)
 		{
@@ -339,6 +353,14 @@ namespace LAYER_NAMESPACE
 	private:
 		PFN_xrSyncActions m_xrSyncActions{ nullptr };
 
+	public:
+		virtual XrResult xrConvertWin32PerformanceCounterToTimeKHR(XrInstance instance, const LARGE_INTEGER* performanceCounter, XrTime* time)
+		{
+			return m_xrConvertWin32PerformanceCounterToTimeKHR(instance, performanceCounter, time);
+		}
+	private:
+		PFN_xrConvertWin32PerformanceCounterToTimeKHR m_xrConvertWin32PerformanceCounterToTimeKHR{ nullptr };
+
 
 
 	};
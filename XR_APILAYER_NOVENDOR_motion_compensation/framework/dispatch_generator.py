@@ -252,7 +252,10 @@ namespace LAYER_NAMESPACE
                 generated += f'''		else if (apiName == "{cur_cmd.name}")
 		{{
 			m_{cur_cmd.name} = reinterpret_cast<PFN_{cur_cmd.name}>(*function);
-			*function = reinterpret_cast<PFN_xrVoidFunction>(LAYER_NAMESPACE::{cur_cmd.name});
+			if (IsOverrideRequired(apiName))
+			{{
+				*function = reinterpret_cast<PFN_xrVoidFunction>(LAYER_NAMESPACE::{cur_cmd.name});
+			}}
 		}}
 '''
 
@@ -262,8 +265,11 @@ namespace LAYER_NAMESPACE
                 generated += f'''		else if (apiName == "{cur_cmd.name}")
 		{{
 			m_{cur_cmd.name} = reinterpret_cast<PFN_{cur_cmd.name}>(*function);
-			*function = reinterpret_cast<PFN_xrVoidFunction>(LAYER_NAMESPACE::{cur_cmd.name});
-			result = XR_SUCCESS;
+			if (IsOverrideRequired(apiName))
+			{{
+				*function = reinterpret_cast<PFN_xrVoidFunction>(LAYER_NAMESPACE::{cur_cmd.name});
+				result = XR_SUCCESS;
+			}}
 		}}
 '''
 
@@ -334,6 +340,12 @@ namespace LAYER_NAMESPACE
             return (bool)m_grantedExtensions.count(extensionName);
         }
 
+		// Overrides that aren't required hand out the next function pointer to avoid the indirection.
+		virtual bool IsOverrideRequired(const std::string& apiName) const
+		{
+			return true;
+		}
+
 		// Specially-handled by the auto-generated code.
 		virtual XrResult xrGetInstanceProcAddr(XrInstance instance, const char* name, PFN_xrVoidFunction* function);
 		virtual XrResult xrCreateInstance(const XrInstanceCreateInfo* createInfo);
@@ -77,6 +77,7 @@ XrResult __declspec(dllexport) XRAPI_CALL
         std::string logFile = (localAppData / (LayerPrettyName + ".log")).string();
         logStream.open(logFile, std::ios_base::ate);
     }
+    StartLogWriter();
 
     DebugLog("--> xrNegotiateLoaderApiLayerInterface\n");
 
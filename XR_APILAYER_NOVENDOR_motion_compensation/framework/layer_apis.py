@@ -16,8 +16,11 @@ override_functions = [
     "xrSuggestInteractionProfileBindings",
     "xrSyncActions",
     "xrCreateReferenceSpace",
+    "xrCreateActionSpace",
     "xrLocateSpace",
+    "xrDestroySpace",
     "xrLocateViews",
+    "xrWaitFrame",
     "xrEndFrame"
 ]
 
@@ -37,8 +40,9 @@ requested_functions = [
     "xrEnumerateSwapchainImages",
     "xrDestroyAction",
     "xrDestroyActionSet",
-    "xrDestroySpace"
+    "xrDestroySpace",
+    "xrConvertWin32PerformanceCounterToTimeKHR"
 ]
 
 # The list of OpenXR extensions our layer will either override or use.
-extensions = ["XR_EXT_hp_mixed_reality_controller"]
+extensions = ["XR_EXT_hp_mixed_reality_controller", "XR_KHR_win32_convert_performance_counter_time"]
@@ -22,9 +22,48 @@
 
 #include "pch.h"
 
+#include "log.h"
+
 namespace {
-    constexpr uint32_t k_maxLoggedErrors = 100;
-    uint32_t g_globalErrorCount = 0;
+    // Errors are rate-limited per call site, identified by the address of the format string.
+    constexpr uint32_t k_maxErrorsPerInterval = 10;
+    constexpr auto k_errorInterval = 10s;
+    // Table size, needs to be a power of two. Filled up to half to keep probing short.
+    constexpr size_t k_maxErrorSites = 1024;
+
+    struct ErrorSite {
+        const char* fmt{nullptr};
+        std::chrono::steady_clock::time_point intervalStart;
+        uint32_t count{0};
+        uint32_t suppressed{0};
+    };
+    std::mutex g_errorSitesMutex;
+    // Preallocated, so neither logged nor suppressed errors allocate memory.
+    std::array<ErrorSite, k_maxErrorSites> g_errorSites;
+    size_t g_errorSiteCount = 0;
+
+    // Only to be called with g_errorSitesMutex held.
+    ErrorSite& GetErrorSite(const char* fmt) {
+        size_t index = std::hash<const char*>{}(fmt) & (k_maxErrorSites - 1);
+        while (g_errorSites[index].fmt && g_errorSites[index].fmt != fmt) {
+            index = (index + 1) & (k_maxErrorSites - 1);
+        }
+        if (!g_errorSites[index].fmt) {
+            if (g_errorSiteCount >= k_maxErrorSites / 2) {
+                // Forget about all call sites rather than growing.
+                g_errorSites.fill({});
+                g_errorSiteCount = 0;
+                return GetErrorSite(fmt);
+            }
+            g_errorSites[index].fmt = fmt;
+            g_errorSiteCount++;
+        }
+        return g_errorSites[index];
+    }
+
+    // Capacity of the log queue, needs to be a power of two.
+    constexpr size_t k_logQueueSize = 256;
+    constexpr auto k_logWriterInterval = 10ms;
 } // namespace
 
 namespace LAYER_NAMESPACE::log {
@@ -39,31 +78,212 @@ namespace LAYER_NAMESPACE::log {
 
     namespace {
 
-        // Utility logging function.
-        void InternalLog(const char* fmt, va_list va) {
-            SYSTEMTIME lt;
-            GetLocalTime(&lt);
+        struct LogRecord {
+            // Position in the queue this record is ready for (written = position + 1).
+            std::atomic<size_t> sequence;
+            SYSTEMTIME time;
+            char text[1024];
+        };
 
-            char buf[1024];
-            size_t offset = sprintf(buf,
-                                    "%d-%02d-%02d %02d:%02d:%02d.%03d: ",
-                                    lt.wYear,
-                                    lt.wMonth,
-                                    lt.wDay,
-                                    lt.wHour,
-                                    lt.wMinute,
-                                    lt.wSecond,
-                                    lt.wMilliseconds);
-
-            vsnprintf_s(buf + offset, sizeof(buf) - offset, _TRUNCATE, fmt, va);
+        // Bounded lock-free queue with multiple producers and the log writer thread as only consumer.
+        struct LogQueue {
+            LogQueue() {
+                for (size_t i = 0; i < k_logQueueSize; i++) {
+                    records[i].sequence.store(i, std::memory_order_relaxed);
+                }
+            }
+
+            LogRecord records[k_logQueueSize];
+            std::atomic<size_t> enqueuePosition{0};
+            size_t dequeuePosition{0};
+        };
+
+        LogQueue g_logQueue;
+        std::atomic<uint32_t> g_droppedRecords{0};
+        std::atomic_bool g_logWriterActive{false};
+        // Producers between the check of g_logWriterActive and the publication of their record.
+        std::atomic<uint32_t> g_activeProducers{0};
+        std::atomic_bool g_stopLogWriter{false};
+        // The writer is joined by ResetInstance(). Joining isn't possible under the loader lock during static
+        // destruction, so don't block or terminate on unload if the layer hasn't been torn down.
+        struct LogWriterThread {
+            ~LogWriterThread() {
+                if (thread.joinable()) {
+                    thread.detach();
+                }
+            }
+            std::thread thread;
+        } g_logWriter;
+        std::mutex g_logStreamMutex;
+
+        void WriteRecord(const SYSTEMTIME& lt, const char* text) {
+            char buf[1024 + 32];
+            sprintf_s(buf,
+                      "%d-%02d-%02d %02d:%02d:%02d.%03d: %s",
+                      lt.wYear,
+                      lt.wMonth,
+                      lt.wDay,
+                      lt.wHour,
+                      lt.wMinute,
+                      lt.wSecond,
+                      lt.wMilliseconds,
+                      text);
             OutputDebugStringA(buf);
+            std::unique_lock lock(g_logStreamMutex);
             if (logStream.is_open()) {
                 logStream << buf;
+            }
+        }
+
+        void FlushStream() {
+            std::unique_lock lock(g_logStreamMutex);
+            if (logStream.is_open()) {
                 logStream.flush();
             }
         }
+
+        // Returns false if the queue is full.
+        bool PushRecord(const char* fmt, va_list va) {
+            size_t position = g_logQueue.enqueuePosition.load(std::memory_order_relaxed);
+            LogRecord* record;
+            while (true) {
+                record = &g_logQueue.records[position & (k_logQueueSize - 1)];
+                const intptr_t difference =
+                    (intptr_t)record->sequence.load(std::memory_order_acquire) - (intptr_t)position;
+                if (difference == 0) {
+                    if (g_logQueue.enqueuePosition.compare_exchange_weak(
+                            position, position + 1, std::memory_order_relaxed)) {
+                        break;
+                    }
+                } else if (difference < 0) {
+                    return false;
+                } else {
+                    position = g_logQueue.enqueuePosition.load(std::memory_order_relaxed);
+                }
+            }
+            // Arguments may reference temporaries of the caller, so the message itself can't be formatted later.
+            GetLocalTime(&record->time);
+            vsnprintf_s(record->text, sizeof(record->text), _TRUNCATE, fmt, va);
+            record->sequence.store(position + 1, std::memory_order_release);
+            return true;
+        }
+
+        // Only to be called by one thread at a time.
+        size_t DrainRecords() {
+            size_t count = 0;
+            while (true) {
+                LogRecord& record = g_logQueue.records[g_logQueue.dequeuePosition & (k_logQueueSize - 1)];
+                if (record.sequence.load(std::memory_order_acquire) != g_logQueue.dequeuePosition + 1) {
+                    break;
+                }
+                WriteRecord(record.time, record.text);
+                record.sequence.store(g_logQueue.dequeuePosition + k_logQueueSize, std::memory_order_release);
+                g_logQueue.dequeuePosition++;
+                count++;
+            }
+            const uint32_t dropped = g_droppedRecords.exchange(0);
+            if (dropped) {
+                SYSTEMTIME lt;
+                GetLocalTime(&lt);
+                char buf[64];
+                sprintf_s(buf, "%u log record(s) dropped\n", dropped);
+                WriteRecord(lt, buf);
+            }
+            if (count || dropped) {
+                FlushStream();
+            }
+            return count;
+        }
+
+        void LogSuppressed(const char* fmt, uint32_t suppressed) {
+            Log("error - %u similar message(s) suppressed: %s%s",
+                suppressed,
+                fmt,
+                *fmt && fmt[strlen(fmt) - 1] == '\n' ? "" : "\n");
+        }
+
+        // Summarize call sites that stopped logging before their interval was over.
+        void ReportSuppressedErrors(bool all) {
+            std::vector<std::pair<const char*, uint32_t>> reports;
+            {
+                std::unique_lock lock(g_errorSitesMutex);
+                const auto now = std::chrono::steady_clock::now();
+                for (auto& site : g_errorSites) {
+                    if (site.suppressed && (all || now - site.intervalStart >= k_errorInterval)) {
+                        reports.push_back({site.fmt, std::exchange(site.suppressed, 0)});
+                    }
+                }
+            }
+            for (const auto& [fmt, suppressed] : reports) {
+                LogSuppressed(fmt, suppressed);
+            }
+        }
+
+        void LogWriter() {
+            auto lastReport = std::chrono::steady_clock::now();
+            while (!g_stopLogWriter) {
+                DrainRecords();
+                if (std::chrono::steady_clock::now() - lastReport >= k_errorInterval) {
+                    ReportSuppressedErrors(false);
+                    lastReport = std::chrono::steady_clock::now();
+                }
+                std::this_thread::sleep_for(k_logWriterInterval);
+            }
+            // All producers have finished, so every claimed record is published.
+            while (g_logQueue.dequeuePosition != g_logQueue.enqueuePosition.load()) {
+                DrainRecords();
+            }
+            // Written synchronously, the writer has already been deactivated.
+            ReportSuppressedErrors(true);
+        }
+
+        // Utility logging function.
+        void InternalLog(const char* fmt, va_list va) {
+            if (g_logWriterActive) {
+                // Checked again after registering, StopLogWriter() waits for registered producers.
+                g_activeProducers++;
+                if (g_logWriterActive) {
+                    // Time stamp formatting and file output are done by the log writer thread.
+                    if (!PushRecord(fmt, va)) {
+                        g_droppedRecords++;
+                    }
+                    g_activeProducers--;
+                    return;
+                }
+                g_activeProducers--;
+            }
+
+            SYSTEMTIME lt;
+            GetLocalTime(&lt);
+            char buf[1024];
+            vsnprintf_s(buf, sizeof(buf), _TRUNCATE, fmt, va);
+            WriteRecord(lt, buf);
+            FlushStream();
+        }
     } // namespace
 
+    void StartLogWriter() {
+        if (g_logWriter.thread.joinable()) {
+            return;
+        }
+        g_stopLogWriter = false;
+        g_logWriter.thread = std::thread(LogWriter);
+        g_logWriterActive = true;
+    }
+
+    void StopLogWriter() {
+        if (!g_logWriter.thread.joinable()) {
+            return;
+        }
+        g_logWriterActive = false;
+        // Records of producers that passed the check before are drained by the writer before it exits.
+        while (g_activeProducers) {
+            std::this_thread::yield();
+        }
+        g_stopLogWriter = true;
+        g_logWriter.thread.join();
+    }
+
     void Log(const char* fmt, ...) {
         va_list va;
         va_start(va, fmt);
@@ -72,15 +292,33 @@ namespace LAYER_NAMESPACE::log {
     }
 
     void ErrorLog(const char* fmt, ...) {
-        if (g_globalErrorCount++ < k_maxLoggedErrors) {
-            va_list va;
-            va_start(va, fmt);
-            InternalLog((std::string("error - ")+ fmt).c_str(), va);
-            va_end(va);
-            if (g_globalErrorCount == k_maxLoggedErrors) {
-                Log("Maximum number of errors logged. Going silent.");
+        uint32_t suppressed = 0;
+        {
+            std::unique_lock lock(g_errorSitesMutex);
+            ErrorSite& site = GetErrorSite(fmt);
+            const auto now = std::chrono::steady_clock::now();
+            if (now - site.intervalStart >= k_errorInterval) {
+                suppressed = std::exchange(site.suppressed, 0);
+                site.intervalStart = now;
+                site.count = 0;
             }
+            if (site.count >= k_maxErrorsPerInterval) {
+                // Skip formatting entirely.
+                site.suppressed++;
+                return;
+            }
+            site.count++;
+        }
+        if (suppressed) {
+            LogSuppressed(fmt, suppressed);
         }
+        // Prefixed on the stack, format strings are far shorter than a log record.
+        char errorFmt[1024];
+        _snprintf_s(errorFmt, sizeof(errorFmt), _TRUNCATE, "error - %s", fmt);
+        va_list va;
+        va_start(va, fmt);
+        InternalLog(errorFmt, va);
+        va_end(va);
     }
 
     void DebugLog(const char* fmt, ...) {
@@ -35,7 +35,22 @@ namespace LAYER_NAMESPACE::log {
 #define TraceLocalActivity(activity) TraceLoggingActivity<g_traceProvider> activity;
 
 #define TLArg(var, ...) TraceLoggingValue(var, ##__VA_ARGS__)
-#define TLPArg(var, ...) TraceLoggingValue(fmt::format("0x{:08x}", (uintptr_t)(var)).c_str(), ##__VA_ARGS__)
+#define TLPArg(var, ...) TraceLoggingPointer((const void*)(uintptr_t)(var), ##__VA_ARGS__)
+
+// Emit xr structures as raw fields instead of formatting strings on hot paths.
+#define TLXrPose(var, name)                                                                                            \
+    TraceLoggingStruct(7, name), TraceLoggingFloat32((var).position.x, "X"),                                           \
+        TraceLoggingFloat32((var).position.y, "Y"), TraceLoggingFloat32((var).position.z, "Z"),                        \
+        TraceLoggingFloat32((var).orientation.x, "QX"),                                                                \
+        TraceLoggingFloat32((var).orientation.y, "QY"), TraceLoggingFloat32((var).orientation.z, "QZ"),                \
+        TraceLoggingFloat32((var).orientation.w, "QW")
+#define TLXrFov(var, name)                                                                                             \
+    TraceLoggingStruct(4, name), TraceLoggingFloat32((var).angleLeft, "Left"),                                         \
+        TraceLoggingFloat32((var).angleRight, "Right"), TraceLoggingFloat32((var).angleUp, "Up"),                      \
+        TraceLoggingFloat32((var).angleDown, "Down")
+#define TLXrRect(var, name)                                                                                            \
+    TraceLoggingStruct(4, name), TraceLoggingInt32((var).offset.x, "X"), TraceLoggingInt32((var).offset.y, "Y"),       \
+        TraceLoggingInt32((var).extent.width, "Width"), TraceLoggingInt32((var).extent.height, "Height")
 
     // General logging function.
     void Log(const char* fmt, ...);
@@ -43,7 +58,14 @@ namespace LAYER_NAMESPACE::log {
     // Debug logging function. Can make things very slow (only enabled on Debug builds).
     void DebugLog(const char* fmt, ...);
 
-    // Error logging function. Goes silent after too many errors.
+    // Error logging function. Rate-limited per call site, suppressed messages are summarized periodically.
     void ErrorLog(const char* fmt, ...);
 
+    // Hand log output over to a background thread, callers only format into a queue.
+    // Records are written synchronously while the writer is not running.
+    void StartLogWriter();
+
+    // Write all queued records and stop the background thread.
+    void StopLogWriter();
+
 } // namespace LAYER_NAMESPACE::log
@@ -0,0 +1,142 @@
+// Copyright(c) 2022 Sebastian Veith
+
+#include "pch.h"
+
+#include "latency.h"
+#include "utility.h"
+#include <log.h>
+
+using namespace motion_compensation_layer::log;
+
+namespace Latency
+{
+    LatencyStats::~LatencyStats()
+    {
+        if (m_Block)
+        {
+            UnmapViewOfFile(m_Block);
+        }
+        m_Block = nullptr;
+        if (m_Mapping)
+        {
+            CloseHandle(m_Mapping);
+        }
+        m_Mapping = nullptr;
+    }
+
+    bool LatencyStats::Init()
+    {
+        if (m_Block)
+        {
+            return true;
+        }
+        m_Mapping = CreateFileMappingA(INVALID_HANDLE_VALUE,
+                                       nullptr,
+                                       PAGE_READWRITE,
+                                       0,
+                                       sizeof(StatsBlock),
+                                       SharedMemoryName);
+        if (!m_Mapping)
+        {
+            ErrorLog("%s: unable to create shared memory %s: %s\n",
+                     __FUNCTION__,
+                     SharedMemoryName,
+                     utility::LastErrorMsg().c_str());
+            return false;
+        }
+        m_Block = reinterpret_cast<StatsBlock*>(MapViewOfFile(m_Mapping, FILE_MAP_WRITE, 0, 0, sizeof(StatsBlock)));
+        if (!m_Block)
+        {
+            ErrorLog("%s: unable to map shared memory %s: %s\n",
+                     __FUNCTION__,
+                     SharedMemoryName,
+                     utility::LastErrorMsg().c_str());
+            CloseHandle(m_Mapping);
+            m_Mapping = nullptr;
+            return false;
+        }
+        LARGE_INTEGER frequency;
+        QueryPerformanceFrequency(&frequency);
+        memset(m_Block, 0, sizeof(StatsBlock));
+        m_Block->header = StatsHeader{StatsMagic,
+                                      StatsVersion,
+                                      (uint32_t)Stage::Count,
+                                      BucketCount,
+                                      SubBucketBits,
+                                      LinearBits,
+                                      frequency.QuadPart,
+                                      {}};
+        Log("latency statistics published in %s\n", SharedMemoryName);
+        return true;
+    }
+
+    void LatencyStats::Record(Stage stage, int64_t ticks)
+    {
+        if (!m_Block)
+        {
+            return;
+        }
+        // lock-free update, readers may see a histogram that is in the middle of an update
+        Histogram& histogram = m_Block->histograms[(size_t)stage];
+        InterlockedIncrement64(&histogram.count);
+        InterlockedExchangeAdd64(&histogram.sum, ticks);
+        InterlockedIncrement64(&histogram.buckets[GetBucket(ticks)]);
+        int64_t max = histogram.max;
+        while (ticks > max)
+        {
+            const int64_t previous = InterlockedCompareExchange64(&histogram.max, ticks, max);
+            if (previous == max)
+            {
+                break;
+            }
+            max = previous;
+        }
+    }
+
+    uint32_t LatencyStats::GetBucket(int64_t ticks)
+    {
+        constexpr int64_t linearLimit{1 << LinearBits};
+        if (ticks < linearLimit)
+        {
+            return (uint32_t)std::max<int64_t>(ticks, 0);
+        }
+        unsigned long msb;
+        _BitScanReverse64(&msb, (uint64_t)ticks);
+        const uint32_t bucket = (uint32_t)(linearLimit + (msb - LinearBits) * (1 << SubBucketBits) +
+                                           ((ticks >> (msb - SubBucketBits)) & ((1 << SubBucketBits) - 1)));
+        return std::min(bucket, BucketCount - 1);
+    }
+
+    Timer::Timer(Stage stage) : m_Stage(stage)
+    {
+        QueryPerformanceCounter(&m_Start);
+    }
+
+    Timer::~Timer()
+    {
+        Stop();
+    }
+
+    void Timer::Stop()
+    {
+        if (m_Stopped)
+        {
+            return;
+        }
+        m_Stopped = true;
+        LARGE_INTEGER end;
+        QueryPerformanceCounter(&end);
+        GetLatencyStats()->Record(m_Stage, end.QuadPart - m_Start.QuadPart);
+    }
+} // namespace Latency
+
+std::unique_ptr<Latency::LatencyStats> g_LatencyStats = nullptr;
+
+Latency::LatencyStats* GetLatencyStats()
+{
+    if (!g_LatencyStats)
+    {
+        g_LatencyStats = std::make_unique<Latency::LatencyStats>();
+    }
+    return g_LatencyStats.get();
+}
@@ -0,0 +1,91 @@
+// Copyright(c) 2022 Sebastian Veith
+
+#pragma once
+
+#include "pch.h"
+
+namespace Latency
+{
+    constexpr auto SharedMemoryName{"Local\\OXRMC_LatencyStats"};
+    constexpr uint32_t StatsMagic{0x4C435850}; // "PXCL"
+    constexpr uint32_t StatsVersion{1};
+
+    // log-linear buckets: values below 2^LinearBits are stored exactly, above that each power of two is split into
+    // 2^SubBucketBits buckets
+    constexpr uint32_t SubBucketBits{3};
+    constexpr uint32_t LinearBits{4};
+    constexpr uint32_t BucketCount{256};
+
+    enum class Stage : uint32_t
+    {
+        LocateSpace = 0,
+        LocateViews,
+        EndFrame,
+        SyncActions,
+        MmfRead,
+        Filter,
+        Cache,
+        Overlay,
+        Count
+    };
+
+    // binary layout of the shared memory block, needs to be kept in sync with scripts/print_latency_stats.py
+    // durations are stored in QueryPerformanceCounter() ticks
+    struct Histogram
+    {
+        volatile int64_t count;
+        volatile int64_t sum;
+        volatile int64_t max;
+        volatile int64_t buckets[BucketCount];
+    };
+
+    struct StatsHeader
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t stageCount;
+        uint32_t bucketCount;
+        uint32_t subBucketBits;
+        uint32_t linearBits;
+        int64_t qpcFrequency;
+        uint8_t reserved[32];
+    };
+    static_assert(sizeof(StatsHeader) == 64);
+
+    struct StatsBlock
+    {
+        StatsHeader header;
+        Histogram histograms[(size_t)Stage::Count];
+    };
+
+    class LatencyStats
+    {
+      public:
+        ~LatencyStats();
+        bool Init();
+        void Record(Stage stage, int64_t ticks);
+
+      private:
+        static uint32_t GetBucket(int64_t ticks);
+
+        HANDLE m_Mapping{nullptr};
+        StatsBlock* m_Block{nullptr};
+    };
+
+    // measures the duration between construction and destruction (or Stop)
+    class Timer
+    {
+      public:
+        explicit Timer(Stage stage);
+        ~Timer();
+        void Stop();
+
+      private:
+        Stage m_Stage;
+        LARGE_INTEGER m_Start;
+        bool m_Stopped{false};
+    };
+} // namespace Latency
+
+// Singleton accessor.
+Latency::LatencyStats* GetLatencyStats();
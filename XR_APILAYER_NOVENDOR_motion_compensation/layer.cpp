@@ -27,6 +27,8 @@
 #include "layer.h"
 #include "tracker.h"
 #include "feedback.h"
+#include "recorder.h"
+#include "latency.h"
 #include "utility.h"
 #include "config.h"
 #include "d3dcommon.h"
@@ -41,6 +43,9 @@ namespace motion_compensation_layer
 {
     OpenXrLayer::~OpenXrLayer()
     {
+        StopDeltaWorker();
+        GetConfig()->StopWatcher();
+        GetConfig()->StopWriter();
         if (m_Tracker)
         {
             delete m_Tracker;
@@ -56,6 +61,23 @@ namespace motion_compensation_layer
         return OpenXrApi::xrDestroyInstance(instance);
     }
 
+    bool OpenXrLayer::IsOverrideRequired(const std::string& apiName) const
+    {
+        // function pointers are requested after instance creation, so the configuration is already loaded
+        if (!m_Enabled)
+        {
+            return false;
+        }
+        if (!m_TrackerActionRequired &&
+            ("xrGetCurrentInteractionProfile" == apiName || "xrSuggestInteractionProfileBindings" == apiName ||
+             "xrAttachSessionActionSets" == apiName || "xrSyncActions" == apiName))
+        {
+            // only needed to inject the tracker action
+            return false;
+        }
+        return true;
+    }
+
     XrResult OpenXrLayer::xrCreateInstance(const XrInstanceCreateInfo* createInfo)
     {
         Log("xrCreateInstance\n");
@@ -129,9 +151,39 @@ namespace motion_compensation_layer
             // enable debug test rotation
             GetConfig()->GetBool(Cfg::TestRotation, m_TestRotation);
 
+            // the tracker action is queried by physical trackers and by virtual trackers (including composite) in
+            // cor debug mode, like in RequiresRuntime(). Test rotation doesn't query it, but tracker type and test
+            // rotation can be changed by reloading the config, while the hooks are chosen once and the action set is
+            // only created with the physical tracker enabled
+            std::string trackerType;
+            GetConfig()->GetString(Cfg::TrackerType, trackerType);
+            if (("controller" == trackerType || "vive" == trackerType) && !m_PhysicalEnabled)
+            {
+                ErrorLog("%s: tracker type %s requires physical tracker to be enabled\n",
+                         __FUNCTION__,
+                         trackerType.c_str());
+            }
+            m_TrackerActionRequired = m_PhysicalEnabled;
+            Log("tracker action hooks %s\n", m_TrackerActionRequired ? "installed" : "skipped");
+
+            // enable binary recording of tracker input and output
+            GetRecorder()->Init(m_Application);
+
+            // publish processing time statistics
+            GetLatencyStats()->Init();
+
             // choose cache for reverting pose in xrEndFrame
             GetConfig()->GetBool(Cfg::CacheUseEye, m_UseEyeCache);
 
+            // conversion of timestamps provided by virtual trackers
+            m_PerformanceCounterConversion =
+                IsExtensionGranted(XR_KHR_WIN32_CONVERT_PERFORMANCE_COUNTER_TIME_EXTENSION_NAME);
+            if (!m_PerformanceCounterConversion)
+            {
+                Log("runtime does not support %s, timestamps of virtual tracker samples are ignored\n",
+                    XR_KHR_WIN32_CONVERT_PERFORMANCE_COUNTER_TIME_EXTENSION_NAME);
+            }
+
             float timeout;
             if (GetConfig()->GetFloat(Cfg::TrackerTimeout, timeout))
             {
@@ -166,6 +218,12 @@ namespace motion_compensation_layer
 
         CreateTrackerAction();
 
+        // apply modifications of config files while running
+        if (m_Initialized)
+        {
+            GetConfig()->StartWatcher();
+        }
+
         return result;
     }
 
@@ -293,11 +351,14 @@ namespace motion_compensation_layer
     {
         if (m_Enabled)
         {
+            StopDeltaWorker();
             if (XR_NULL_HANDLE != m_TrackerSpace)
             {
                 GetInstance()->xrDestroySpace(m_TrackerSpace);
                 m_TrackerSpace = XR_NULL_HANDLE;
             }
+            // spaces are destroyed implicitly along with the session
+            m_Spaces.Clear();
             Log("xrDestroySession\n");
             TraceLoggingWrite(g_traceProvider, "xrDestroySession", TLPArg(session, "Session"));
         }
@@ -666,11 +727,16 @@ namespace motion_compensation_layer
                           "xrCreateReferenceSpace",
                           TLPArg(session, "Session"),
                           TLArg(xr::ToCString(createInfo->referenceSpaceType), "ReferenceSpaceType"),
-                          TLArg(xr::ToString(createInfo->poseInReferenceSpace).c_str(), "PoseInReferenceSpace"));
+                          TLXrPose(createInfo->poseInReferenceSpace, "PoseInReferenceSpace"));
 
         const XrResult result = OpenXrApi::xrCreateReferenceSpace(session, createInfo, space);
         if (XR_SUCCEEDED(result))
         {
+            m_Spaces.Insert(*space,
+                            XR_REFERENCE_SPACE_TYPE_VIEW == createInfo->referenceSpaceType    ? SpaceType::View
+                            : XR_REFERENCE_SPACE_TYPE_LOCAL == createInfo->referenceSpaceType ? SpaceType::Local
+                            : XR_REFERENCE_SPACE_TYPE_STAGE == createInfo->referenceSpaceType ? SpaceType::Stage
+                                                                                              : SpaceType::Other);
             if (XR_REFERENCE_SPACE_TYPE_VIEW == createInfo->referenceSpaceType)
             {
                 Log("creation of view space detected: %u\n", *space);
@@ -678,7 +744,6 @@ namespace motion_compensation_layer
 
                 // memorize view spaces
                 TraceLoggingWrite(g_traceProvider, "xrCreateReferenceSpace", TLArg("View_Space", "Added"));
-                m_ViewSpaces.insert(*space);
             }
             else if (XR_REFERENCE_SPACE_TYPE_LOCAL == createInfo->referenceSpaceType)
             {
@@ -711,6 +776,18 @@ namespace motion_compensation_layer
         return result;
     }
 
+    XrResult OpenXrLayer::xrCreateActionSpace(XrSession session,
+                                              const XrActionSpaceCreateInfo* createInfo,
+                                              XrSpace* space)
+    {
+        const XrResult result = OpenXrApi::xrCreateActionSpace(session, createInfo, space);
+        if (m_Enabled && XR_SUCCEEDED(result))
+        {
+            m_Spaces.Insert(*space, SpaceType::Action);
+        }
+        return result;
+    }
+
     XrResult OpenXrLayer::xrLocateSpace(XrSpace space, XrSpace baseSpace, XrTime time, XrSpaceLocation* location)
     {
         if (!m_Enabled)
@@ -733,23 +810,28 @@ namespace motion_compensation_layer
         // determine original location
         CHECK_XRCMD(OpenXrApi::xrLocateSpace(space, baseSpace, time, location));
 
-        if (m_Activated && !m_RecenterInProgress && (isViewSpace(space) || isViewSpace(baseSpace)))
+        // measure processing time of the layer only
+        Latency::Timer timer(Latency::Stage::LocateSpace);
+
+        if (!m_Activated || m_RecenterInProgress)
+        {
+            return XR_SUCCESS;
+        }
+
+        const bool spaceIsViewSpace = isViewSpace(space);
+        const bool baseSpaceIsViewSpace = isViewSpace(baseSpace);
+        if (spaceIsViewSpace || baseSpaceIsViewSpace)
         {
             TraceLoggingWrite(g_traceProvider,
                               "xrLocateSpace",
-                              TLArg(xr::ToString(location->pose).c_str(), "PoseBefore"),
+                              TLXrPose(location->pose, "PoseBefore"),
                               TLArg(location->locationFlags, "LocationFlags"));
 
             // manipulate pose using tracker
-            bool spaceIsViewSpace = isViewSpace(space);
-            bool baseSpaceIsViewSpace = isViewSpace(baseSpace);
 
             XrPosef trackerDelta = Pose::Identity();
-            bool success = !m_TestRotation ? m_Tracker->GetPoseDelta(trackerDelta, m_Session, time)
-                                           : TestRotation(&trackerDelta, time, false);
-            if (success)
+            if (GetTrackerDelta(time, trackerDelta))
             {
-                m_RecoveryStart = 0;
                 if (spaceIsViewSpace && !baseSpaceIsViewSpace)
                 {
                     location->pose = Pose::Multiply(location->pose, trackerDelta);
@@ -760,33 +842,26 @@ namespace motion_compensation_layer
                     location->pose = Pose::Multiply(location->pose, Pose::Invert(trackerDelta));
                 }
             }
-            else
-            {
-                if (0 == m_RecoveryStart)
-                {
-                    ErrorLog("unable to retrieve tracker pose delta\n");
-                    m_RecoveryStart = time;
-                }
-                else if (m_RecoveryWait >= 0 && time - m_RecoveryStart > m_RecoveryWait)
-                {
-                    ErrorLog("tracker connection lost\n");
-                    GetAudioOut()->Execute(Event::ConnectionLost);
-                    m_Activated = false;  
-                    m_RecoveryStart = -1;
-                }
-            }
-
-            // safe pose for use in xrEndFrame
-            m_PoseCache.AddSample(time, trackerDelta);
 
             TraceLoggingWrite(g_traceProvider,
                               "xrLocateSpace",
-                              TLArg(xr::ToString(location->pose).c_str(), "PoseAfter"));
+                              TLXrPose(location->pose, "PoseAfter"));
         }
 
         return XR_SUCCESS;
     }
 
+    XrResult OpenXrLayer::xrDestroySpace(XrSpace space)
+    {
+        const XrResult result = OpenXrApi::xrDestroySpace(space);
+        if (m_Enabled && XR_SUCCEEDED(result))
+        {
+            // handle values may be reused by the runtime
+            m_Spaces.Erase(space);
+        }
+        return result;
+    }
+
     XrResult OpenXrLayer::xrLocateViews(XrSession session,
                                         const XrViewLocateInfo* viewLocateInfo,
                                         XrViewState* viewState,
@@ -821,6 +896,9 @@ namespace motion_compensation_layer
         CHECK_XRCMD(
             OpenXrApi::xrLocateViews(session, viewLocateInfo, viewState, viewCapacityInput, viewCountOutput, views));
 
+        // measure processing time of the layer only
+        Latency::Timer timer(Latency::Stage::LocateViews);
+
         TraceLoggingWrite(g_traceProvider, "xrLocateViews", TLArg(viewState->viewStateFlags, "ViewStateFlags"));
 
         if (!m_Activated)
@@ -829,52 +907,40 @@ namespace motion_compensation_layer
         }
 
         // store eye poses to avoid recalculation in xrEndFrame?
-        std::vector<XrPosef> originalEyePoses{};
-        for (uint32_t i = 0; i < *viewCountOutput; i++)
+        EyePoses originalEyePoses{};
+        originalEyePoses.fill(Pose::Identity());
+        for (uint32_t i = 0; i < std::min(*viewCountOutput, (uint32_t)originalEyePoses.size()); i++)
         {
-            originalEyePoses.push_back(views[i].pose);
+            originalEyePoses[i] = views[i].pose;
         }
         m_EyeCache.AddSample(viewLocateInfo->displayTime, originalEyePoses);
 
-        if (m_EyeOffsets.empty())
-        {
-            // determine eye poses
-            XrViewLocateInfo offsetViewLocateInfo{viewLocateInfo->type,
-                                                  nullptr,
-                                                  viewLocateInfo->viewConfigurationType,
-                                                  viewLocateInfo->displayTime,
-                                                  m_ViewSpace};
-
-            CHECK_XRCMD(OpenXrApi::xrLocateViews(session,
-                                                 &offsetViewLocateInfo,
-                                                 viewState,
-                                                 viewCapacityInput,
-                                                 viewCountOutput,
-                                                 views));
-            for (uint32_t i = 0; i < *viewCountOutput; i++)
-            {
-                m_EyeOffsets.push_back(views[i]);
-            }
+        if (m_RecenterInProgress || isViewSpace(viewLocateInfo->space))
+        {
+            return XR_SUCCESS;
         }
 
-        // manipulate reference space location
-        XrSpaceLocation location{XR_TYPE_SPACE_LOCATION, nullptr};
-        CHECK_XRCMD(xrLocateSpace(m_ViewSpace, viewLocateInfo->space, viewLocateInfo->displayTime, &location));
+        // eye poses are relative to the view pose, so the tracker delta can be applied to them directly
+        XrPosef trackerDelta = Pose::Identity();
+        if (!GetTrackerDelta(viewLocateInfo->displayTime, trackerDelta))
+        {
+            return XR_SUCCESS;
+        }
         for (uint32_t i = 0; i < *viewCountOutput; i++)
         {
-            TraceLoggingWrite(g_traceProvider, "xrLocateViews", TLArg(xr::ToString(views[i].fov).c_str(), "Fov"));
+            TraceLoggingWrite(g_traceProvider, "xrLocateViews", TLXrFov(views[i].fov, "Fov"));
             TraceLoggingWrite(g_traceProvider,
                               "xrLocateViews",
                               TLArg(i, "Index"),
-                              TLArg(xr::ToString(views[i].pose).c_str(), "PoseBefore"));
+                              TLXrPose(views[i].pose, "PoseBefore"));
 
             // apply manipulation
-            views[i].pose = Pose::Multiply(m_EyeOffsets[i].pose, location.pose);
+            views[i].pose = Pose::Multiply(views[i].pose, trackerDelta);
 
             TraceLoggingWrite(g_traceProvider,
                               "xrLocateViews",
                               TLArg(i, "Index"),
-                              TLArg(xr::ToString(views[i].pose).c_str(), "PoseAfter"));
+                              TLXrPose(views[i].pose, "PoseAfter"));
         }
 
         return XR_SUCCESS;
@@ -892,6 +958,7 @@ namespace motion_compensation_layer
         {
             return XR_ERROR_VALIDATION_FAILURE;
         }
+        Latency::Timer timer(Latency::Stage::SyncActions);
         
         TraceLoggingWrite(g_traceProvider, "xrSyncActions", TLPArg(session, "Session"));
         for (uint32_t i = 0; i < syncInfo->countActiveActionSets; i++)
@@ -903,24 +970,79 @@ namespace motion_compensation_layer
         }
 
         XrActionsSyncInfo chainSyncInfo = *syncInfo;
+        // inline storage avoids allocation for the usual small number of action sets
+        std::array<XrActiveActionSet, 16> inlineActionSets;
         std::vector<XrActiveActionSet> newActiveActionSets;
-        const auto trackerActionSet = m_ActionSet;
-        if (trackerActionSet != XR_NULL_HANDLE)
+        const XrActionSet trackerActionSet = m_ActionSet;
+        const uint32_t count = syncInfo->countActiveActionSets;
+        bool trackerIncluded{false};
+        if (m_ActionSetAttached && XR_NULL_HANDLE != trackerActionSet)
+        {
+            trackerIncluded = std::any_of(syncInfo->activeActionSets,
+                                          syncInfo->activeActionSets + count,
+                                          [trackerActionSet](const XrActiveActionSet& activeActionSet) {
+                                              return trackerActionSet == activeActionSet.actionSet;
+                                          });
+            if (!trackerIncluded)
+            {
+                XrActiveActionSet* activeActionSets = inlineActionSets.data();
+                if (count >= inlineActionSets.size())
+                {
+                    newActiveActionSets.resize((size_t)count + 1);
+                    activeActionSets = newActiveActionSets.data();
+                }
+                std::copy_n(syncInfo->activeActionSets, count, activeActionSets);
+                activeActionSets[count] = {trackerActionSet, XR_NULL_PATH};
+
+                chainSyncInfo.activeActionSets = activeActionSets;
+                chainSyncInfo.countActiveActionSets = count + 1;
+                trackerIncluded = true;
+            }
+        }
+
+        timer.Stop();
+        const XrResult result = OpenXrApi::xrSyncActions(session, &chainSyncInfo);
+        if (trackerIncluded && XR_SUCCESS == result)
         {
-            newActiveActionSets.resize((size_t)chainSyncInfo.countActiveActionSets + 1);
-            memcpy(newActiveActionSets.data(),
-                   chainSyncInfo.activeActionSets,
-                   chainSyncInfo.countActiveActionSets * sizeof(XrActionSet));
-            uint32_t nextActionSetSlot = chainSyncInfo.countActiveActionSets;
+            // tracker doesn't need to sync on its own until the end of the current frame
+            m_TrackerSyncedFrame = m_FrameCount.load();
+        }
+        return result;
+    }
 
-            newActiveActionSets[nextActionSetSlot].actionSet = trackerActionSet;
-            newActiveActionSets[nextActionSetSlot++].subactionPath = XR_NULL_PATH;
+    bool OpenXrLayer::IsTrackerActionSynced() const
+    {
+        return m_TrackerSyncedFrame == m_FrameCount;
+    }
 
-            chainSyncInfo.activeActionSets = newActiveActionSets.data();
-            chainSyncInfo.countActiveActionSets = nextActionSetSlot;
+    XrResult OpenXrLayer::xrWaitFrame(XrSession session,
+                                      const XrFrameWaitInfo* frameWaitInfo,
+                                      XrFrameState* frameState)
+    {
+        const XrResult result = OpenXrApi::xrWaitFrame(session, frameWaitInfo, frameState);
+        if (!m_Enabled || !isSessionHandled(session) || XR_FAILED(result))
+        {
+            return result;
         }
 
-        return OpenXrApi::xrSyncActions(session, syncInfo);
+        TraceLoggingWrite(g_traceProvider,
+                          "xrWaitFrame",
+                          TLPArg(session, "Session"),
+                          TLArg(frameState->predictedDisplayTime, "PredictedDisplayTime"));
+
+        if (m_PerformanceCounterConversion && !m_TimeReferenceSet)
+        {
+            SetTimeReference();
+        }
+
+        // calculate delta in advance, subsequent locate calls for the predicted time only apply the result
+        // physical tracker and cor debug mode are left to the first locate call, after the app synced its actions
+        if (m_Activated && !m_RecenterInProgress && (m_TestRotation || !m_Tracker->RequiresRuntime()))
+        {
+            // reading the mmf doesn't involve the runtime and can overlap with the app's frame setup
+            RequestTrackerDelta(frameState->predictedDisplayTime);
+        }
+        return result;
     }
 
     XrResult OpenXrLayer::xrEndFrame(XrSession session, const XrFrameEndInfo* frameEndInfo)
@@ -935,6 +1057,7 @@ namespace motion_compensation_layer
             return XR_ERROR_VALIDATION_FAILURE;
         }
 
+        Latency::Timer timer(Latency::Stage::EndFrame);
         DebugLog("xrEndframe(%u)\n", frameEndInfo->displayTime);
         TraceLoggingWrite(g_traceProvider,
                           "xrEndFrame",
@@ -943,6 +1066,7 @@ namespace motion_compensation_layer
                           TLArg(xr::ToCString(frameEndInfo->environmentBlendMode), "EnvironmentBlendMode"));
 
         m_LastFrameTime = frameEndInfo->displayTime;
+        m_FrameCount++;
         if (m_RecenterInProgress && !m_LocalRefSpaceCreated)
         {
             m_RecenterInProgress = false;
@@ -953,29 +1077,37 @@ namespace motion_compensation_layer
        
         XrPosef referenceTrackerPose = m_Tracker->GetReferencePose(m_Session, chainFrameEndInfo.displayTime);
 
-        XrPosef reversedManipulation;
-        std::vector<XrPosef> cachedEyePoses;
+        XrPosef reversedManipulation{Pose::Identity()};
+        EyePoses cachedEyePoses{};
         if (m_Activated)
         {
+            Latency::Timer cacheTimer(Latency::Stage::Cache);
             reversedManipulation = Pose::Invert(m_PoseCache.GetSample(chainFrameEndInfo.displayTime));
             m_PoseCache.CleanUp(chainFrameEndInfo.displayTime);
-            cachedEyePoses =
-                m_UseEyeCache ? m_EyeCache.GetSample(chainFrameEndInfo.displayTime) : std::vector<XrPosef>();
+            if (m_UseEyeCache)
+            {
+                cachedEyePoses = m_EyeCache.GetSample(chainFrameEndInfo.displayTime);
+            }
             m_EyeCache.CleanUp(chainFrameEndInfo.displayTime);
         }
 
-        m_Overlay->DrawOverlay(&chainFrameEndInfo, referenceTrackerPose, reversedManipulation, m_Activated);
+        {
+            Latency::Timer overlayTimer(Latency::Stage::Overlay);
+            m_Overlay->DrawOverlay(&chainFrameEndInfo, referenceTrackerPose, reversedManipulation, m_Activated);
+        }
 
         if (!m_Activated)
         {
+            ApplyConfigChanges();
             HandleKeyboardInput(chainFrameEndInfo.displayTime);
+            timer.Stop();
             return OpenXrApi::xrEndFrame(session, &chainFrameEndInfo);
         }
 
-        std::vector<const XrCompositionLayerBaseHeader*> resetLayers{};
-        std::vector<XrCompositionLayerProjection*> resetProjectionLayers{};
-        std::vector<XrCompositionLayerQuad*> resetQuadLayers{};
-        std::vector<std::vector<XrCompositionLayerProjectionView>*> resetViews{};
+        // memory of the previous frame is no longer referenced by the runtime
+        m_FrameArena.Reset();
+        const XrCompositionLayerBaseHeader** const resetLayers =
+            m_FrameArena.Allocate<const XrCompositionLayerBaseHeader*>(chainFrameEndInfo.layerCount);
 
         // use pose cache for reverse calculation 
         for (uint32_t i = 0; i < chainFrameEndInfo.layerCount; i++)
@@ -995,18 +1127,16 @@ namespace motion_compensation_layer
                                   TLArg(projectionLayer->layerFlags, "Flags"),
                                   TLPArg(projectionLayer->space, "Space"));
 
-                std::vector<XrCompositionLayerProjectionView>* projectionViews =
-                    new std::vector<XrCompositionLayerProjectionView>{};
-                resetViews.push_back(projectionViews);
-                projectionViews->resize(projectionLayer->viewCount);
-                memcpy(projectionViews->data(),
+                XrCompositionLayerProjectionView* const projectionViews =
+                    m_FrameArena.Allocate<XrCompositionLayerProjectionView>(projectionLayer->viewCount);
+                memcpy(projectionViews,
                        projectionLayer->views,
                        projectionLayer->viewCount * sizeof(XrCompositionLayerProjectionView));
 
                 TraceLoggingWrite(g_traceProvider,
                                   "xrEndFrame_View",
                                   TLArg("Reversed_Manipulation", "Type"),
-                                  TLArg(xr::ToString(reversedManipulation).c_str(), "Pose"));
+                                  TLXrPose(reversedManipulation, "Pose"));
 
                 for (uint32_t j = 0; j < projectionLayer->viewCount; j++)
                 {
@@ -1014,34 +1144,34 @@ namespace motion_compensation_layer
                         g_traceProvider,
                         "xrEndFrame_View",
                         TLArg("View_Before", "Type"),
-                        TLArg(xr::ToString((*projectionViews)[j].pose).c_str(), "Pose"),
+                        TLXrPose(projectionViews[j].pose, "Pose"),
                         TLArg(j, "Index"),
-                        TLPArg((*projectionViews)[j].subImage.swapchain, "Swapchain"),
-                        TLArg((*projectionViews)[j].subImage.imageArrayIndex, "ImageArrayIndex"),
-                        TLArg(xr::ToString((*projectionViews)[j].subImage.imageRect).c_str(), "ImageRect"),
-                        TLArg(xr::ToString((*projectionViews)[j].fov).c_str(), "Fov"));
+                        TLPArg(projectionViews[j].subImage.swapchain, "Swapchain"),
+                        TLArg(projectionViews[j].subImage.imageArrayIndex, "ImageArrayIndex"),
+                        TLXrRect(projectionViews[j].subImage.imageRect, "ImageRect"),
+                        TLXrFov(projectionViews[j].fov, "Fov"));
 
-                    XrPosef reversedEyePose = m_UseEyeCache
+                    XrPosef reversedEyePose = m_UseEyeCache && j < cachedEyePoses.size()
                                                   ? cachedEyePoses[j]
-                                                  : Pose::Multiply((*projectionViews)[j].pose, reversedManipulation);
-                    (*projectionViews)[j].pose = reversedEyePose;
+                                                  : Pose::Multiply(projectionViews[j].pose, reversedManipulation);
+                    projectionViews[j].pose = reversedEyePose;
 
                     TraceLoggingWrite(g_traceProvider,
                                       "xrEndFrame_View",
                                       TLArg("View_After", "Type"),
-                                      TLArg(xr::ToString((*projectionViews)[j].pose).c_str(), "Pose"),
+                                      TLXrPose(projectionViews[j].pose, "Pose"),
                                       TLArg(j, "Index"));
                 }
             
                 // create layer with reset view poses
                 XrCompositionLayerProjection* const resetProjectionLayer =
-                    new XrCompositionLayerProjection{projectionLayer->type,
-                                                     projectionLayer->next,
-                                                     projectionLayer->layerFlags,
-                                                     projectionLayer->space,
-                                                     projectionLayer->viewCount,
-                                                     projectionViews->data()};
-                resetProjectionLayers.push_back(resetProjectionLayer);
+                    m_FrameArena.Allocate<XrCompositionLayerProjection>();
+                *resetProjectionLayer = {projectionLayer->type,
+                                         projectionLayer->next,
+                                         projectionLayer->layerFlags,
+                                         projectionLayer->space,
+                                         projectionLayer->viewCount,
+                                         projectionViews};
                 resetBaseHeader = reinterpret_cast<XrCompositionLayerBaseHeader*>(resetProjectionLayer);
             }
             else if (XR_TYPE_COMPOSITION_LAYER_QUAD == baseHeader.type && !isViewSpace(baseHeader.space))
@@ -1057,7 +1187,7 @@ namespace motion_compensation_layer
                                   TLArg("QuadLayer", "Type"),
                                   TLArg(quadLayer->layerFlags, "Flags"),
                                   TLPArg(quadLayer->space, "Space"),
-                                  TLArg(xr::ToString(quadLayer->pose).c_str(), "Pose"));
+                                  TLXrPose(quadLayer->pose, "Pose"));
 
                 // apply reverse manipulation to quad layer pose
                 XrPosef resetPose = Pose::Multiply(quadLayer->pose, reversedManipulation);
@@ -1065,29 +1195,23 @@ namespace motion_compensation_layer
                 TraceLoggingWrite(g_traceProvider,
                                   "xrEndFrame_Layer",
                                   TLArg("QuadLayer_After", "Type"),
-                                  TLArg(xr::ToString(resetPose).c_str(), "Pose"));
+                                  TLXrPose(resetPose, "Pose"));
 
                 // create quad layer with reset pose
-                XrCompositionLayerQuad* const resetQuadLayer = new XrCompositionLayerQuad{quadLayer->type,
-                                                                                          quadLayer->next,
-                                                                                          quadLayer->layerFlags,
-                                                                                          quadLayer->space,
-                                                                                          quadLayer->eyeVisibility,
-                                                                                          quadLayer->subImage,
-                                                                                          resetPose,
-                                                                                          quadLayer->size};
-                resetQuadLayers.push_back(resetQuadLayer);
+                XrCompositionLayerQuad* const resetQuadLayer = m_FrameArena.Allocate<XrCompositionLayerQuad>();
+                *resetQuadLayer = {quadLayer->type,
+                                   quadLayer->next,
+                                   quadLayer->layerFlags,
+                                   quadLayer->space,
+                                   quadLayer->eyeVisibility,
+                                   quadLayer->subImage,
+                                   resetPose,
+                                   quadLayer->size};
                 resetBaseHeader = reinterpret_cast<XrCompositionLayerBaseHeader*>(resetQuadLayer);
             }
-            if (resetBaseHeader)
-            {
-                resetLayers.push_back(resetBaseHeader);
-            }
-            else
-            {
-                resetLayers.push_back(chainFrameEndInfo.layers[i]);
-            }
+            resetLayers[i] = resetBaseHeader ? resetBaseHeader : chainFrameEndInfo.layers[i];
         }
+        ApplyConfigChanges();
         HandleKeyboardInput(chainFrameEndInfo.displayTime);
 
         XrFrameEndInfo resetFrameEndInfo{chainFrameEndInfo.type,
@@ -1095,25 +1219,98 @@ namespace motion_compensation_layer
                                          chainFrameEndInfo.displayTime,
                                          chainFrameEndInfo.environmentBlendMode,
                                          chainFrameEndInfo.layerCount,
-                                         resetLayers.data()};
+                                         resetLayers};
 
-        XrResult result = OpenXrApi::xrEndFrame(session, &resetFrameEndInfo);
+        timer.Stop();
+        return OpenXrApi::xrEndFrame(session, &resetFrameEndInfo);
+    }
 
-        // clean up memory
-        for (auto projection : resetProjectionLayers)
+    bool OpenXrLayer::GetTrackerDelta(XrTime time, XrPosef& trackerDelta, bool* deferred)
+    {
+        bool success = !m_TestRotation ? m_Tracker->GetPoseDelta(trackerDelta, m_Session, time, deferred)
+                                       : TestRotation(&trackerDelta, time, false);
+        if (deferred && *deferred)
         {
-            delete projection;
+            // calculated on the app thread by the first locate call instead
+            return false;
         }
-        for (auto quad : resetQuadLayers)
         {
-            delete quad;
+            // xrLocateSpace may be called from multiple threads
+            std::unique_lock lock(m_RecoveryMutex);
+            if (success)
+            {
+                m_RecoveryStart = 0;
+            }
+            else if (0 == m_RecoveryStart)
+            {
+                ErrorLog("unable to retrieve tracker pose delta\n");
+                m_RecoveryStart = time;
+            }
+            else if (m_RecoveryWait >= 0 && time - m_RecoveryStart > m_RecoveryWait)
+            {
+                ErrorLog("tracker connection lost\n");
+                GetAudioOut()->Execute(Event::ConnectionLost);
+                m_Activated = false;
+                m_RecoveryStart = -1;
+            }
         }
-        for (auto views : resetViews)
+
+        // safe pose for use in xrEndFrame, poses that haven't been manipulated don't need to be reverted
+        if (success)
         {
-            delete views;
+            m_PoseCache.AddSample(time, trackerDelta);
         }
 
-        return result;
+        return success;
+    }
+
+    void OpenXrLayer::RequestTrackerDelta(XrTime time)
+    {
+        std::unique_lock lock(m_DeltaMutex);
+        if (!m_DeltaWorker.joinable())
+        {
+            m_StopDeltaWorker = false;
+            m_DeltaWorker = std::thread(&OpenXrLayer::DeltaWorker, this);
+        }
+        m_DeltaRequest = time;
+        m_DeltaSignal.notify_one();
+    }
+
+    void OpenXrLayer::StopDeltaWorker()
+    {
+        {
+            std::unique_lock lock(m_DeltaMutex);
+            if (!m_DeltaWorker.joinable())
+            {
+                return;
+            }
+            m_StopDeltaWorker = true;
+        }
+        m_DeltaSignal.notify_one();
+        m_DeltaWorker.join();
+    }
+
+    void OpenXrLayer::DeltaWorker()
+    {
+        std::unique_lock lock(m_DeltaMutex);
+        while (true)
+        {
+            m_DeltaSignal.wait(lock, [this] { return m_StopDeltaWorker || 0 != m_DeltaRequest; });
+            if (m_StopDeltaWorker)
+            {
+                return;
+            }
+            const XrTime time = m_DeltaRequest;
+            m_DeltaRequest = 0;
+            lock.unlock();
+
+            // never call the runtime from here, it would overlap with the app's own calls
+            XrPosef trackerDelta{Pose::Identity()};
+            bool deferred{false};
+            GetTrackerDelta(time, trackerDelta, &deferred);
+
+            lock.lock();
+        }
     }
 
     bool OpenXrLayer::GetStageToLocalSpace(XrTime time, XrPosef& pose)
@@ -1133,7 +1330,7 @@ namespace motion_compensation_layer
                     pose = location.pose;
                     TraceLoggingWrite(g_traceProvider,
                                       "LocateLocalInStageSpace",
-                                      TLArg(xr::ToString(pose).c_str(), "StageToLocalPose"));
+                                      TLXrPose(pose, "StageToLocalPose"));
                     return true;
                 }
                 else
@@ -1154,6 +1351,37 @@ namespace motion_compensation_layer
         return false;
     }
 
+    bool OpenXrLayer::ConvertToXrTime(int64_t performanceCounter, XrTime& time) const
+    {
+        if (!m_TimeReferenceSet.load(std::memory_order_acquire))
+        {
+            return false;
+        }
+        // split into seconds and remainder to avoid overflow of the multiplication
+        const int64_t ticks = performanceCounter - m_QpcReference;
+        time = m_XrTimeReference + ticks / m_QpcFrequency * 1000000000 +
+               ticks % m_QpcFrequency * 1000000000 / m_QpcFrequency;
+        return true;
+    }
+
+    void OpenXrLayer::SetTimeReference()
+    {
+        LARGE_INTEGER frequency, counter;
+        QueryPerformanceFrequency(&frequency);
+        QueryPerformanceCounter(&counter);
+        XrTime time;
+        if (XR_FAILED(OpenXrApi::xrConvertWin32PerformanceCounterToTimeKHR(GetXrInstance(), &counter, &time)))
+        {
+            ErrorLog("%s: xrConvertWin32PerformanceCounterToTimeKHR failed\n", __FUNCTION__);
+            m_PerformanceCounterConversion = false;
+            return;
+        }
+        m_QpcFrequency = frequency.QuadPart;
+        m_QpcReference = counter.QuadPart;
+        m_XrTimeReference = time;
+        m_TimeReferenceSet.store(true, std::memory_order_release);
+    }
+
     // private
     bool OpenXrLayer::isSystemHandled(XrSystemId systemId) const
     {
@@ -1167,7 +1395,13 @@ namespace motion_compensation_layer
 
     bool OpenXrLayer::isViewSpace(XrSpace space) const
     {
-        return m_ViewSpaces.count(space);
+        return SpaceType::View == GetSpaceType(space);
+    }
+
+    OpenXrLayer::SpaceType OpenXrLayer::GetSpaceType(XrSpace space) const
+    {
+        const SpaceType* type = m_Spaces.Find(space);
+        return type ? *type : SpaceType::Other;
     }
 
     uint32_t OpenXrLayer::GetNumViews()
@@ -1336,7 +1570,8 @@ namespace motion_compensation_layer
         std::string trackerType;
         if (GetConfig()->GetString(Cfg::TrackerType, trackerType))
         {
-            if ("yaw" == trackerType || "srs" == trackerType || "flypt" == trackerType)
+            if ("yaw" == trackerType || "srs" == trackerType || "flypt" == trackerType ||
+                "composite" == trackerType)
             {
                 Tracker::VirtualTracker* tracker = reinterpret_cast<Tracker::VirtualTracker*>(m_Tracker);
                 if (tracker)
@@ -1388,6 +1623,8 @@ namespace motion_compensation_layer
 
     void OpenXrLayer::ReloadConfig()
     {
+        // tracker is replaced below
+        StopDeltaWorker();
         m_Tracker->m_Calibrated = false;
         m_Activated = false;
         bool success = GetConfig()->Init(m_Application);
@@ -1395,6 +1632,7 @@ namespace motion_compensation_layer
         {
             GetConfig()->GetBool(Cfg::TestRotation, m_TestRotation);
             GetConfig()->GetBool(Cfg::CacheUseEye, m_UseEyeCache);
+            GetRecorder()->Init(m_Application);
             Tracker::GetTracker(&m_Tracker);
             if (!m_Tracker->Init())
             {
@@ -1404,12 +1642,77 @@ namespace motion_compensation_layer
         GetAudioOut()->Execute(!success ? Event::Error : Event::Load);
     }
 
+    void OpenXrLayer::ApplyConfigChanges()
+    {
+        // set is reused, constructing an empty std::set allocates on every frame
+        std::set<Cfg>& changed = m_ChangedConfig;
+        changed.clear();
+        if (!GetConfig()->ReloadChanges(changed) || changed.empty())
+        {
+            return;
+        }
+        const auto isChanged = [&changed](std::initializer_list<Cfg> keys) {
+            return std::any_of(keys.begin(), keys.end(), [&changed](Cfg key) { return changed.contains(key); });
+        };
+        if (isChanged({Cfg::PhysicalEnabled, Cfg::TrackerSide}))
+        {
+            ErrorLog("%s: modified tracker activation or side is applied after restart of the application\n",
+                     __FUNCTION__);
+        }
+        if (isChanged({Cfg::TrackerType, Cfg::TrackerCheck, Cfg::CompositeRotation, Cfg::CompositeTranslation}))
+        {
+            // tracker needs to be recreated
+            ReloadConfig();
+            return;
+        }
+
+        // remaining values are applied individually, center of rotation and yaw game engine offset are read on
+        // next recalibration anyway
+        bool success = m_Tracker->ApplyConfig(changed);
+        if (isChanged({Cfg::TestRotation}))
+        {
+            GetConfig()->GetBool(Cfg::TestRotation, m_TestRotation);
+        }
+        if (isChanged({Cfg::CacheUseEye}))
+        {
+            GetConfig()->GetBool(Cfg::CacheUseEye, m_UseEyeCache);
+        }
+        float value;
+        if (isChanged({Cfg::CacheTolerance}) && GetConfig()->GetFloat(Cfg::CacheTolerance, value))
+        {
+            const XrTime toleranceTime = (XrTime)(value * 1000000.0);
+            m_PoseCache.SetTolerance(toleranceTime);
+            m_EyeCache.SetTolerance(toleranceTime);
+            Log("cache tolerance is set to %.3f ms\n", value);
+        }
+        if (isChanged({Cfg::TrackerTimeout}) && GetConfig()->GetFloat(Cfg::TrackerTimeout, value))
+        {
+            m_RecoveryWait = (XrTime)(value * 1000000000.0);
+            Log("tracker timeout is set to %.3f ms\n", m_RecoveryWait / 1000000.0);
+        }
+        if (isChanged({Cfg::RecordPoses}) && !GetRecorder()->Init(m_Application))
+        {
+            success = false;
+        }
+        // shortcuts are defined contiguously from KeyActivate to KeyDebugCor
+        if ((isChanged({Cfg::InputScript}) ||
+             std::any_of(changed.cbegin(),
+                         changed.cend(),
+                         [](Cfg key) { return Cfg::KeyActivate <= key && Cfg::KeyDebugCor >= key; })) &&
+            !m_Input.Init())
+        {
+            success = false;
+        }
+        GetAudioOut()->Execute(!success ? Event::Error : Event::Load);
+    }
+
     void OpenXrLayer::SaveConfig(XrTime time, bool forApp)
     {
         std::string trackerType;
         if (GetConfig()->GetString(Cfg::TrackerType, trackerType))
         {
-            if ("yaw" == trackerType || "srs" == trackerType || "flypt" == trackerType)
+            if ("yaw" == trackerType || "srs" == trackerType || "flypt" == trackerType ||
+                "composite" == trackerType)
             {
                 Tracker::VirtualTracker* tracker = reinterpret_cast<Tracker::VirtualTracker*>(m_Tracker);
                 if (tracker)
@@ -1431,7 +1734,8 @@ namespace motion_compensation_layer
         std::string trackerType;
         if (GetConfig()->GetString(Cfg::TrackerType, trackerType))
         {
-            if ("yaw" == trackerType || "srs" == trackerType || "flypt" == trackerType)
+            if ("yaw" == trackerType || "srs" == trackerType || "flypt" == trackerType ||
+                "composite" == trackerType)
             {
                 Tracker::VirtualTracker* tracker = reinterpret_cast<Tracker::VirtualTracker*>(m_Tracker);
                 if (tracker)
@@ -1479,7 +1783,8 @@ namespace motion_compensation_layer
         }
         std::string trackerType;
         if (m_StageSpace == XR_NULL_HANDLE && GetConfig()->GetString(Cfg::TrackerType, trackerType) &&
-            ("yaw" == trackerType || "srs" == trackerType || "flypt" == trackerType))
+            ("yaw" == trackerType || "srs" == trackerType || "flypt" == trackerType ||
+             "composite" == trackerType))
         {
             Log("reference space created during lazy init\n");
             // Create a reference space.
@@ -1525,86 +1830,99 @@ namespace motion_compensation_layer
 
     void OpenXrLayer::HandleKeyboardInput(XrTime time)
     {
+        Cfg key;
         bool isRepeat{false};
-        if (m_Input.GetKeyState(Cfg::KeyActivate, isRepeat) && !isRepeat)
+        while (m_Input.GetEvent(key, isRepeat))
         {
-            ToggleActive(time);
-        }
-        if (m_Input.GetKeyState(Cfg::KeyCenter, isRepeat) && !isRepeat)
-        {
-            Recalibrate(time);
-        }
-        if (m_Input.GetKeyState(Cfg::KeyTransInc, isRepeat))
-        {
-            m_Tracker->ModifyFilterStrength(true, true);
-        }
-        if (m_Input.GetKeyState(Cfg::KeyTransDec, isRepeat))
-        {
-            m_Tracker->ModifyFilterStrength(true, false);
-        }
-        if (m_Input.GetKeyState(Cfg::KeyRotInc, isRepeat))
-        {
-            m_Tracker->ModifyFilterStrength(false, true);
-        }
-        if (m_Input.GetKeyState(Cfg::KeyRotDec, isRepeat))
-        {
-            m_Tracker->ModifyFilterStrength(false, false);
-        }
-        if (m_Input.GetKeyState(Cfg::KeyOffForward, isRepeat))
-        {
-           ChangeOffset(Direction::Fwd);
-        }
-        if (m_Input.GetKeyState(Cfg::KeyOffBack, isRepeat))
-        {
-            ChangeOffset(Direction::Back);
-        }
-        if (m_Input.GetKeyState(Cfg::KeyOffUp, isRepeat))
-        {
-            ChangeOffset(Direction::Up);
-        }
-        if (m_Input.GetKeyState(Cfg::KeyOffDown, isRepeat))
-        {
-            ChangeOffset(Direction::Down);
-        }
-        if (m_Input.GetKeyState(Cfg::KeyOffRight, isRepeat))
-        {
-            ChangeOffset(Direction::Right);
-        }
-        if (m_Input.GetKeyState(Cfg::KeyOffLeft, isRepeat))
-        {
-            ChangeOffset(Direction::Left);
-        }
-        if (m_Input.GetKeyState(Cfg::KeyRotRight, isRepeat))
-        {
-            ChangeOffset(Direction::RotRight);
-        }
-        if (m_Input.GetKeyState(Cfg::KeyRotLeft, isRepeat))
-        {
-            ChangeOffset(Direction::RotLeft);
-        }
-        if (m_Input.GetKeyState(Cfg::KeyOverlay, isRepeat) && !isRepeat)
-        {
-            ToggleOverlay();
-        }
-        if (m_Input.GetKeyState(Cfg::KeyCache, isRepeat) && !isRepeat)
-        {
-            ToggleCache();
-        }
-        if (m_Input.GetKeyState(Cfg::KeySaveConfig, isRepeat) && !isRepeat)
-        {
-            SaveConfig(time, false);
-        }
-        if (m_Input.GetKeyState(Cfg::KeySaveConfigApp, isRepeat) && !isRepeat)
-        {
-            SaveConfig(time, true);
-        }
-        if (m_Input.GetKeyState(Cfg::KeyReloadConfig, isRepeat) && !isRepeat)
-        {
-            ReloadConfig();
-        }
-        if (m_Input.GetKeyState(Cfg::KeyDebugCor, isRepeat) && !isRepeat)
-        {
-            ToggleCorDebug(time);
+            switch (key)
+            {
+            case Cfg::KeyActivate:
+                if (!isRepeat)
+                {
+                    ToggleActive(time);
+                }
+                break;
+            case Cfg::KeyCenter:
+                if (!isRepeat)
+                {
+                    Recalibrate(time);
+                }
+                break;
+            case Cfg::KeyTransInc:
+                m_Tracker->ModifyFilterStrength(true, true);
+                break;
+            case Cfg::KeyTransDec:
+                m_Tracker->ModifyFilterStrength(true, false);
+                break;
+            case Cfg::KeyRotInc:
+                m_Tracker->ModifyFilterStrength(false, true);
+                break;
+            case Cfg::KeyRotDec:
+                m_Tracker->ModifyFilterStrength(false, false);
+                break;
+            case Cfg::KeyOffForward:
+                ChangeOffset(Direction::Fwd);
+                break;
+            case Cfg::KeyOffBack:
+                ChangeOffset(Direction::Back);
+                break;
+            case Cfg::KeyOffUp:
+                ChangeOffset(Direction::Up);
+                break;
+            case Cfg::KeyOffDown:
+                ChangeOffset(Direction::Down);
+                break;
+            case Cfg::KeyOffRight:
+                ChangeOffset(Direction::Right);
+                break;
+            case Cfg::KeyOffLeft:
+                ChangeOffset(Direction::Left);
+                break;
+            case Cfg::KeyRotRight:
+                ChangeOffset(Direction::RotRight);
+                break;
+            case Cfg::KeyRotLeft:
+                ChangeOffset(Direction::RotLeft);
+                break;
+            case Cfg::KeyOverlay:
+                if (!isRepeat)
+                {
+                    ToggleOverlay();
+                }
+                break;
+            case Cfg::KeyCache:
+                if (!isRepeat)
+                {
+                    ToggleCache();
+                }
+                break;
+            case Cfg::KeySaveConfig:
+                if (!isRepeat)
+                {
+                    SaveConfig(time, false);
+                }
+                break;
+            case Cfg::KeySaveConfigApp:
+                if (!isRepeat)
+                {
+                    SaveConfig(time, true);
+                }
+                break;
+            case Cfg::KeyReloadConfig:
+                if (!isRepeat)
+                {
+                    ReloadConfig();
+                }
+                break;
+            case Cfg::KeyDebugCor:
+                if (!isRepeat)
+                {
+                    ToggleCorDebug(time);
+                }
+                break;
+            default:
+                break;
+            }
         }
     }
 
@@ -1654,6 +1972,8 @@ namespace motion_compensation_layer
     void ResetInstance()
     {
         g_instance.reset();
+        // after the layer's own teardown has been logged, joining the writer isn't possible on dll unload
+        StopLogWriter();
     }
 
 } // namespace motion_compensation_layer
@@ -46,6 +46,7 @@ namespace motion_compensation_layer
 
         virtual ~OpenXrLayer();
         XrResult xrDestroyInstance(XrInstance instance) override;
+        bool IsOverrideRequired(const std::string& apiName) const override;
 
         XrResult xrCreateInstance(const XrInstanceCreateInfo* createInfo) override;
         XrResult xrGetSystem(XrInstance instance, const XrSystemGetInfo* getInfo, XrSystemId* systemId) override;
@@ -76,7 +77,11 @@ namespace motion_compensation_layer
         XrResult xrCreateReferenceSpace(XrSession session,
                                         const XrReferenceSpaceCreateInfo* createInfo,
                                         XrSpace* space) override;
+        XrResult xrCreateActionSpace(XrSession session,
+                                     const XrActionSpaceCreateInfo* createInfo,
+                                     XrSpace* space) override;
         XrResult xrLocateSpace(XrSpace space, XrSpace baseSpace, XrTime time, XrSpaceLocation* location) override;
+        XrResult xrDestroySpace(XrSpace space) override;
         XrResult xrLocateViews(XrSession session,
                                const XrViewLocateInfo* viewLocateInfo,
                                XrViewState* viewState,
@@ -84,8 +89,14 @@ namespace motion_compensation_layer
                                uint32_t* viewCountOutput,
                                XrView* views) override;
         XrResult xrSyncActions(XrSession session, const XrActionsSyncInfo* syncInfo) override;
+        XrResult xrWaitFrame(XrSession session,
+                             const XrFrameWaitInfo* frameWaitInfo,
+                             XrFrameState* frameState) override;
         XrResult xrEndFrame(XrSession session, const XrFrameEndInfo* frameEndInfo) override;
         bool GetStageToLocalSpace(XrTime time, XrPosef& location);
+        bool IsTrackerActionSynced() const;
+        // only arithmetic, may be called from any thread
+        bool ConvertToXrTime(int64_t performanceCounter, XrTime& time) const;
 
         XrActionSet m_ActionSet{XR_NULL_HANDLE};
         XrAction m_TrackerPoseAction{XR_NULL_HANDLE};
@@ -107,9 +118,23 @@ namespace motion_compensation_layer
             RotLeft
         };
 
+        // eye poses of up to four views, stored inline to avoid allocations per frame
+        using EyePoses = std::array<XrPosef, 4>;
+
+        // classification of spaces, determined once on creation
+        enum class SpaceType : uint8_t
+        {
+            Other = 0,
+            View,
+            Local,
+            Stage,
+            Action
+        };
+
         bool isSystemHandled(XrSystemId systemId) const;
         bool isSessionHandled(XrSession session) const;
         bool isViewSpace(XrSpace space) const;
+        SpaceType GetSpaceType(XrSpace space) const;
         uint32_t GetNumViews();
         void CreateTrackerAction();
         void CreateTrackerActionSpace();
@@ -119,10 +144,16 @@ namespace motion_compensation_layer
         void ToggleCache();
         void ChangeOffset(Direction dir);
         void ReloadConfig();
+        void ApplyConfigChanges();
         void SaveConfig(XrTime time, bool forApp);
         void ToggleCorDebug(XrTime time);
         bool LazyInit(XrTime time);
+        bool GetTrackerDelta(XrTime time, XrPosef& trackerDelta, bool* deferred = nullptr);
+        void RequestTrackerDelta(XrTime time);
+        void StopDeltaWorker();
+        void DeltaWorker();
         void HandleKeyboardInput(XrTime time);
+        void SetTimeReference();
 
         static std::string getXrPath(XrPath path);
 
@@ -133,28 +164,49 @@ namespace motion_compensation_layer
         std::string m_RuntimeName;
         bool m_Enabled{false};
         bool m_PhysicalEnabled{false};
+        // decides about the action related hooks, determined once on instance creation
+        bool m_TrackerActionRequired{false};
         bool m_ActionSetAttached{false};
         bool m_InteractionProfileSuggested{false};
         bool m_Initialized{true};
-        bool m_Activated{false};
+        std::atomic_bool m_Activated{false};
         bool m_UseEyeCache{false};
+        bool m_PerformanceCounterConversion{false};
+        // performance counter value matching an XrTime, determined once on the app thread
+        std::atomic_bool m_TimeReferenceSet{false};
+        int64_t m_QpcFrequency{1};
+        int64_t m_QpcReference{0};
+        XrTime m_XrTimeReference{0};
         std::string m_Application;
-        std::set<XrSpace> m_ViewSpaces{};
-        std::vector<XrView> m_EyeOffsets{};
+        utility::HandleTable<XrSpace, SpaceType> m_Spaces;
         XrViewConfigurationType m_ViewConfigType{XR_VIEW_CONFIGURATION_TYPE_MAX_ENUM};
         Tracker::TrackerBase* m_Tracker{nullptr};
         Tracker::ViveTrackerInfo m_ViveTracker;
         utility::Cache<XrPosef> m_PoseCache{xr::math::Pose::Identity()};
-        utility::Cache<std::vector<XrPosef>> m_EyeCache{std::vector<XrPosef>{xr::math::Pose::Identity(),
-                                                                             xr::math::Pose::Identity(),
-                                                                             xr::math::Pose::Identity(),
-                                                                             xr::math::Pose::Identity()}};
+        utility::Cache<EyePoses> m_EyeCache{EyePoses{xr::math::Pose::Identity(),
+                                                     xr::math::Pose::Identity(),
+                                                     xr::math::Pose::Identity(),
+                                                     xr::math::Pose::Identity()}};
         utility::KeyboardInput m_Input;
+        std::set<Cfg> m_ChangedConfig;
+        utility::FrameArena m_FrameArena;
         std::unique_ptr<graphics::Overlay> m_Overlay;
 
         // connection recovery
         XrTime m_RecoveryWait{3000000000}; // 3 sec default timeout
         XrTime m_RecoveryStart{0};
+        std::mutex m_RecoveryMutex;
+
+        // detection of xrSyncActions calls by the application that include the tracker action set
+        std::atomic<int64_t> m_FrameCount{0};
+        std::atomic<int64_t> m_TrackerSyncedFrame{-1};
+
+        // precalculation of tracker delta for predicted display time
+        std::thread m_DeltaWorker;
+        std::mutex m_DeltaMutex;
+        std::condition_variable m_DeltaSignal;
+        XrTime m_DeltaRequest{0};
+        bool m_StopDeltaWorker{false};
 
         // recentering of in-game view
         XrTime m_LastFrameTime{0};
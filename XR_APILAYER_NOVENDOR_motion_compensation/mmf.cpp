@@ -0,0 +1,314 @@
+// Copyright(c) 2022 Sebastian Veith
+
+#include "pch.h"
+
+#include "mmf.h"
+#include <log.h>
+
+using namespace motion_compensation_layer::log;
+
+namespace utility
+{
+    Mmf::~Mmf()
+    {
+        StopListener();
+        Close();
+    }
+
+    void Mmf::SetName(const std::string& name)
+    {
+        m_Name = name;
+    }
+
+    void Mmf::SetRefreshInterval(XrTime interval)
+    {
+        std::unique_lock lock(m_Mutex);
+        m_Check = interval;
+    }
+
+    XrTime Mmf::GetRefreshInterval()
+    {
+        std::unique_lock lock(m_Mutex);
+        return m_Check;
+    }
+
+    void Mmf::SetListener(size_t size, SampleListener listener)
+    {
+        StopListener();
+        m_SampleSize = size;
+        m_OnSample = std::move(listener);
+    }
+
+    bool Mmf::Open(XrTime time)
+    {
+        std::unique_lock lock(m_Mutex);
+        return OpenView(time);
+    }
+
+    bool Mmf::Read(void* buffer, size_t size, XrTime time, MmfHeader* header)
+    {
+        std::unique_lock lock(m_Mutex);
+        if (m_Check > 0 && time - m_LastRefresh > m_Check)
+        {
+            CloseView();
+        }
+        if (!m_View)
+        {
+            OpenView(time);
+        }
+        if (!m_View)
+        {
+            return false;
+        }
+        CheckListener(time);
+        return ReadView(buffer, size, header);
+    }
+
+    void Mmf::Close()
+    {
+        std::unique_lock lock(m_Mutex);
+        CloseView();
+    }
+
+    uint64_t Mmf::GetTornReads() const
+    {
+        return m_TornReads;
+    }
+
+    bool Mmf::OpenView(XrTime time)
+    {
+        m_FileHandle = OpenFileMapping(FILE_MAP_READ, FALSE, m_Name.c_str());
+
+        if (m_FileHandle)
+        {
+            m_View = MapViewOfFile(m_FileHandle, FILE_MAP_READ, 0, 0, 0);
+            if (m_View != NULL)
+            {
+                m_LastRefresh = time;
+                m_ConnectionLost = false;
+            }
+            else
+            {
+                DWORD err = GetLastError();
+                ErrorLog("unable to map view of mmf %s: %s\n", m_Name.c_str(), LastErrorMsg().c_str());
+                CloseView();
+                return false;
+            }
+        }
+        else
+        {
+            if (!m_ConnectionLost)
+            {
+                ErrorLog("could not open file mapping object %s: %s", m_Name.c_str(), LastErrorMsg().c_str());
+                m_ConnectionLost = true;
+            }
+            return false;
+        }
+        return true;
+    }
+
+    bool Mmf::ReadView(void* buffer, size_t size, MmfHeader* header)
+    {
+        try
+        {
+            if (MmfMagic == reinterpret_cast<const MmfHeader*>(m_View)->magic)
+            {
+                if (!ReadExtended(buffer, size, header))
+                {
+                    return false;
+                }
+            }
+            else
+            {
+                // legacy layout without header
+                memcpy(buffer, m_View, size);
+                if (header)
+                {
+                    *header = MmfHeader{};
+                }
+            }
+        }
+        catch (std::exception e)
+        {
+            ErrorLog("%s: unable to read from mmf %s: %s\n", __FUNCTION__, m_Name.c_str(), e.what());
+            // reset mmf connection
+            CloseView();
+            return false;
+        }
+        return true;
+    }
+
+    bool Mmf::ReadExtended(void* buffer, size_t size, MmfHeader* header)
+    {
+        const volatile MmfHeader* mmfHeader = reinterpret_cast<const volatile MmfHeader*>(m_View);
+        const void* data = reinterpret_cast<const char*>(m_View) + sizeof(MmfHeader);
+        if (MmfVersion != mmfHeader->version)
+        {
+            ErrorLog("%s: unsupported mmf protocol version in %s: %u\n", __FUNCTION__, m_Name.c_str(), mmfHeader->version);
+            return false;
+        }
+
+        // retry if the producer modified the sample while it was copied
+        for (int attempt = 0; attempt < 3; attempt++)
+        {
+            const uint64_t sequence = mmfHeader->sequence;
+            const int64_t qpcTime = mmfHeader->qpcTime;
+            std::atomic_thread_fence(std::memory_order_acquire);
+            memcpy(buffer, data, size);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (!(sequence & 1) && sequence == mmfHeader->sequence)
+            {
+                if (header)
+                {
+                    header->magic = MmfMagic;
+                    header->version = MmfVersion;
+                    header->sequence = sequence;
+                    header->qpcTime = qpcTime;
+                }
+                return true;
+            }
+            m_TornReads++;
+        }
+        ErrorLog("%s: unable to read consistent sample from mmf %s\n", __FUNCTION__, m_Name.c_str());
+        return false;
+    }
+
+    void Mmf::CloseView()
+    {
+        if (m_View)
+        {
+            UnmapViewOfFile(m_View);
+        }
+        m_View = nullptr;
+        if (m_FileHandle)
+        {
+            CloseHandle(m_FileHandle);
+        }
+        m_FileHandle = nullptr;
+    }
+
+    void Mmf::CheckListener(XrTime time)
+    {
+        if (!m_OnSample)
+        {
+            return;
+        }
+        if (m_Listener.joinable())
+        {
+            if (m_ListenerRunning)
+            {
+                return;
+            }
+            // listener stopped on error, poll until it is restarted
+            m_Listener.join();
+            CloseHandle(m_Event);
+            m_Event = nullptr;
+            m_NextEventCheck = time + m_EventCheckInterval;
+            ErrorLog("%s: event-signalled update of mmf %s stopped, falling back to polling\n",
+                     __FUNCTION__,
+                     m_Name.c_str());
+            return;
+        }
+        if (time >= m_NextEventCheck)
+        {
+            // notification is optional, check again later in case the producer creates the event afterwards
+            m_NextEventCheck = time + m_EventCheckInterval;
+            StartListener();
+        }
+    }
+
+    bool Mmf::StartListener()
+    {
+        if (!m_Event)
+        {
+            m_Event = OpenEvent(SYNCHRONIZE, FALSE, (m_Name + MmfEventSuffix).c_str());
+            if (!m_Event)
+            {
+                return false;
+            }
+        }
+        Log("event-signalled update of mmf %s enabled\n", m_Name.c_str());
+        m_StopListener = false;
+        m_ListenerRunning = true;
+        m_Listener = std::thread(&Mmf::Listen, this);
+        return true;
+    }
+
+    void Mmf::StopListener()
+    {
+        if (m_Listener.joinable())
+        {
+            m_StopListener = true;
+            m_Listener.join();
+        }
+        if (m_Event)
+        {
+            CloseHandle(m_Event);
+        }
+        m_Event = nullptr;
+        m_NextEventCheck = 0;
+    }
+
+    void Mmf::Listen()
+    {
+        std::vector<char> sample(m_SampleSize);
+        MmfHeader header{};
+        while (!m_StopListener)
+        {
+            // time out periodically to allow for shutdown
+            const DWORD result = WaitForSingleObject(m_Event, 100);
+            if (WAIT_OBJECT_0 == result)
+            {
+                bool available{false};
+                {
+                    std::unique_lock lock(m_Mutex);
+                    available = m_View && ReadView(sample.data(), sample.size(), &header);
+                }
+                TraceLoggingWrite(g_traceProvider,
+                                  "Mmf::Listen",
+                                  TLArg(m_Name.c_str(), "Name"),
+                                  TLArg(available, "Available"),
+                                  TLArg(header.sequence, "Sequence"));
+                if (available)
+                {
+                    // hand over every sample, the tracker keeps its history independent of the frame rate
+                    m_OnSample(sample.data(), header);
+                }
+            }
+            else if (WAIT_TIMEOUT != result)
+            {
+                ErrorLog("%s: waiting for event of mmf %s failed: %s\n",
+                         __FUNCTION__,
+                         m_Name.c_str(),
+                         LastErrorMsg().c_str());
+                break;
+            }
+        }
+        m_ListenerRunning = false;
+    }
+
+    std::string LastErrorMsg()
+    {
+        DWORD error = GetLastError();
+        if (error)
+        {
+            LPVOID buffer;
+            DWORD bufLen = FormatMessage(FORMAT_MESSAGE_ALLOCATE_BUFFER | FORMAT_MESSAGE_FROM_SYSTEM |
+                                             FORMAT_MESSAGE_IGNORE_INSERTS,
+                                         NULL,
+                                         error,
+                                         MAKELANGID(LANG_NEUTRAL, SUBLANG_DEFAULT),
+                                         (LPTSTR)&buffer,
+                                         0,
+                                         NULL);
+            if (bufLen)
+            {
+                LPCSTR lpStr = (LPCSTR)buffer;
+                std::string result(lpStr, lpStr + bufLen);
+                LocalFree(buffer);
+                return std::to_string(error) + " - " + result;
+            }
+        }
+        return "0";
+    }
+} // namespace utility
@@ -0,0 +1,78 @@
+// Copyright(c) 2022 Sebastian Veith
+
+#pragma once
+
+#include "pch.h"
+
+namespace utility
+{
+    // optional header in front of tracker data, enables timestamped (extended) mmf protocol
+    struct MmfHeader
+    {
+        uint32_t magic{0};
+        uint32_t version{0};
+        // incremented by the producer before and after writing a sample (odd value = write in progress)
+        uint64_t sequence{0};
+        // QueryPerformanceCounter() value at the time the sample was taken
+        int64_t qpcTime{0};
+    };
+    constexpr uint32_t MmfMagic{0x4D43584F}; // "OXCM"
+    constexpr uint32_t MmfVersion{1};
+    // optional named event signalled by the producer after each write: <mmf name> + MmfEventSuffix
+    constexpr auto MmfEventSuffix{"_Event"};
+    // names of the mmfs provided by supported motion software
+    constexpr auto YawMmfName{"Local\\YawVRGEFile"};
+    constexpr auto FlyPtMmfName{"Local\\motionRigPose"};
+    constexpr auto SrsMmfName{"Local\\SimRacingStudioMotionRigPose"};
+
+    class Mmf
+    {
+      public:
+        // called on the listener thread for each sample signalled by the producer
+        using SampleListener = std::function<void(const void* data, const MmfHeader& header)>;
+
+        ~Mmf();
+        void SetName(const std::string& name);
+        // interval for reopening the mmf, 0 keeps the view open as long as reading succeeds
+        void SetRefreshInterval(XrTime interval);
+        XrTime GetRefreshInterval();
+        // has to be set before the mmf is read for the first time
+        void SetListener(size_t size, SampleListener listener);
+        bool Open(XrTime time);
+        bool Read(void* buffer, size_t size, XrTime time, MmfHeader* header = nullptr);
+        void Close();
+        // number of read attempts that were interrupted by the producer
+        uint64_t GetTornReads() const;
+
+      private:
+        bool OpenView(XrTime time);
+        bool ReadView(void* buffer, size_t size, MmfHeader* header);
+        bool ReadExtended(void* buffer, size_t size, MmfHeader* header);
+        void CloseView();
+        void CheckListener(XrTime time);
+        bool StartListener();
+        void StopListener();
+        void Listen();
+
+        XrTime m_Check{1000000000}; // reopen mmf once a second by default
+        XrTime m_LastRefresh{0};
+        std::string m_Name;
+        HANDLE m_FileHandle{nullptr};
+        void* m_View{nullptr};
+        bool m_ConnectionLost{false};
+        std::mutex m_Mutex;
+        std::atomic<uint64_t> m_TornReads{0};
+
+        // event-signalled updates
+        SampleListener m_OnSample;
+        size_t m_SampleSize{0};
+        HANDLE m_Event{nullptr};
+        XrTime m_NextEventCheck{0};
+        const XrTime m_EventCheckInterval{1000000000};
+        std::thread m_Listener;
+        std::atomic_bool m_StopListener{false};
+        std::atomic_bool m_ListenerRunning{false};
+    };
+
+    std::string LastErrorMsg();
+} // namespace utility
@@ -38,14 +38,13 @@ namespace graphics
 {
     Overlay::~Overlay()
     {
-        m_Swapchains.clear();
+        m_Swapchains.Clear();
     }
     void Overlay::CreateSession(const XrSessionCreateInfo* createInfo,
                                 XrSession* session,
                                 const std::string& runtimeName)
     {
         m_Initialized = true;
-        m_OwnDepthBuffers.clear();
 
         OpenXrLayer* layer = reinterpret_cast<OpenXrLayer*>(GetInstance());
         if (layer)
@@ -85,10 +84,11 @@ namespace graphics
 
                 if (m_GraphicsDevice)
                 {
-                    std::vector<graphics::SimpleMeshVertex> vertices = CreateMarker(true);
-                    std::vector<uint16_t> indices = CreateIndices(vertices.size());
+                    std::vector<graphics::SimpleMeshVertex> vertices;
+                    std::vector<uint16_t> indices;
+                    CreateMarker(true, vertices, indices);
                     m_MeshRGB = m_GraphicsDevice->createSimpleMesh(vertices, indices, "RGB Mesh");
-                    vertices = CreateMarker(false);
+                    CreateMarker(false, vertices, indices);
                     m_MeshCMY = m_GraphicsDevice->createSimpleMesh(vertices, indices, "CMY Mesh");
                     
                     if (m_GraphicsDevice->getApi() != graphics::Api::D3D11 &&
@@ -247,17 +247,13 @@ namespace graphics
                     }
                 }
 
-                if (m_OwnDepthBuffers.find(*swapchain) == m_OwnDepthBuffers.cend())
-                {
-                    XrSwapchainCreateInfo depthInfo = *createInfo;
-                    depthInfo.usageFlags = XR_SWAPCHAIN_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
-                         
-                    std::shared_ptr<ITexture> texture =
-                        m_GraphicsDevice->createTexture(depthInfo, "depth buffer", DXGI_FORMAT_D32_FLOAT);
-                    m_OwnDepthBuffers.insert_or_assign(*swapchain, texture);
-                }
+                XrSwapchainCreateInfo depthInfo = *createInfo;
+                depthInfo.usageFlags = XR_SWAPCHAIN_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
+                swapchainState.ownDepthBuffer =
+                    m_GraphicsDevice->createTexture(depthInfo, "depth buffer", DXGI_FORMAT_D32_FLOAT);
 
-                m_Swapchains.insert_or_assign(*swapchain, swapchainState);
+                m_Swapchains.Insert(*swapchain, std::move(swapchainState));
+                m_TargetsValid = false;
 
                 TraceLoggingWrite(g_traceProvider, "xrCreateSwapchain", TLPArg(*swapchain, "Swapchain"));
             }
@@ -276,7 +272,8 @@ namespace graphics
 
     void Overlay::DestroySwapchain(XrSwapchain swapchain)
     {
-            m_Swapchains.erase(swapchain);
+            m_Swapchains.Erase(swapchain);
+            m_TargetsValid = false;
     }
 
     XrResult Overlay::AcquireSwapchainImage(XrSwapchain swapchain,
@@ -287,16 +284,16 @@ namespace graphics
         OpenXrLayer* layer = reinterpret_cast<OpenXrLayer*>(GetInstance());
         if (layer)
         {
-            auto swapchainIt = m_Swapchains.find(swapchain);
-            if (swapchainIt != m_Swapchains.end())
+            graphics::SwapchainState* swapchainState = m_Swapchains.Find(swapchain);
+            if (swapchainState)
             {
                 // Perform the release now in case it was delayed.
-                if (swapchainIt->second.delayedRelease)
+                if (swapchainState->delayedRelease)
                 {
                     TraceLoggingWrite(g_traceProvider, "ForcedSwapchainRelease", TLPArg(swapchain, "Swapchain"));
 
                     XrSwapchainImageReleaseInfo releaseInfo{XR_TYPE_SWAPCHAIN_IMAGE_RELEASE_INFO, nullptr};
-                    swapchainIt->second.delayedRelease = false;
+                    swapchainState->delayedRelease = false;
                     CHECK_XRCMD(layer->OpenXrApi::xrReleaseSwapchainImage(swapchain, &releaseInfo));
                 }
             }
@@ -305,9 +302,9 @@ namespace graphics
             if (XR_SUCCEEDED(result))
             {
                 // Record the index so we know which texture to use in xrEndFrame().
-                if (swapchainIt != m_Swapchains.end())
+                if (swapchainState)
                 {
-                    swapchainIt->second.acquiredImageIndex = *index;
+                    swapchainState->acquiredImageIndex = *index;
                 }
 
                 TraceLoggingWrite(g_traceProvider, "xrAcquireSwapchainImage", TLArg(*index, "Index"));
@@ -328,11 +325,11 @@ namespace graphics
         OpenXrLayer* layer = reinterpret_cast<OpenXrLayer*>(GetInstance());
         if (layer)
         {
-            auto swapchainIt = m_Swapchains.find(swapchain);
-            if (swapchainIt != m_Swapchains.end())
+            graphics::SwapchainState* swapchainState = m_Swapchains.Find(swapchain);
+            if (swapchainState)
             {
                 // Perform a delayed release: we still need to write to the swapchain in our xrEndFrame()!
-                swapchainIt->second.delayedRelease = true;
+                swapchainState->delayedRelease = true;
                 return XR_SUCCESS;
             }
 
@@ -373,109 +370,58 @@ namespace graphics
                 m_GraphicsDevice->saveContext();
                 m_GraphicsDevice->unsetRenderTargets();
 
-                std::shared_ptr<graphics::ITexture> textureForOverlay[graphics::ViewCount]{};
-                uint32_t sliceForOverlay[graphics::ViewCount]{};
-                std::shared_ptr<graphics::ITexture> depthForOverlay[graphics::ViewCount]{};
-                xr::math::ViewProjection viewForOverlay[graphics::ViewCount]{};
-                XrRect2Di viewportForOverlay[graphics::ViewCount];
-
-                std::vector<XrCompositionLayerProjection> layerProjectionAllocator;
-                std::vector<std::array<XrCompositionLayerProjectionView, 2>> layerProjectionViewsAllocator;
-
+                // the last projection layer is used for rendering
+                const XrCompositionLayerProjection* projection{nullptr};
                 for (uint32_t i = 0; i < chainFrameEndInfo->layerCount; i++)
                 {
                     if (chainFrameEndInfo->layers[i]->type == XR_TYPE_COMPOSITION_LAYER_PROJECTION)
                     {
-                        const XrCompositionLayerProjection* proj =
+                        projection =
                             reinterpret_cast<const XrCompositionLayerProjection*>(chainFrameEndInfo->layers[i]);
-                        for (uint32_t eye = 0; eye < graphics::ViewCount; eye++)
-                        {
-                            const XrCompositionLayerProjectionView& view = proj->views[eye];
-
-                            auto swapchainIt = m_Swapchains.find(view.subImage.swapchain);
-                            if (swapchainIt == m_Swapchains.end())
-                            {
-                                throw std::runtime_error("Swapchain is not registered");
-                            }
-                            auto& swapchainState = swapchainIt->second;
-                            auto& swapchainImages = swapchainState.images[swapchainState.acquiredImageIndex];
-
-                            // Look for the depth buffer.
-                            std::shared_ptr<graphics::ITexture> depthBuffer;
-                            xr::math::NearFar nearFar{0.001f, 100.f};
-                            const XrBaseInStructure* entry = reinterpret_cast<const XrBaseInStructure*>(view.next);
-                            while (entry)
-                            {
-                                if (entry->type == XR_TYPE_COMPOSITION_LAYER_DEPTH_INFO_KHR)
-                                {
-                                    DebugLog("Depthbuffer found\n ");
-                                    const XrCompositionLayerDepthInfoKHR* depth =
-                                        reinterpret_cast<const XrCompositionLayerDepthInfoKHR*>(entry);
-
-                                    TraceLoggingWrite(
-                                        g_traceProvider,
-                                        "xrEndFrame_View",
-                                        TLArg("Depth", "Type"),
-                                        TLArg(eye, "Index"),
-                                        TLPArg(depth->subImage.swapchain, "Swapchain"),
-                                        TLArg(depth->subImage.imageArrayIndex, "ImageArrayIndex"),
-                                        TLArg(xr::ToString(depth->subImage.imageRect).c_str(), "ImageRect"),
-                                        TLArg(depth->nearZ, "Near"),
-                                        TLArg(depth->farZ, "Far"),
-                                        TLArg(depth->minDepth, "MinDepth"),
-                                        TLArg(depth->maxDepth, "MaxDepth"));
-
-                                    // The order of color/depth textures must match.
-                                    if (depth->subImage.imageArrayIndex == view.subImage.imageArrayIndex)
-                                    {
-                                        auto depthSwapchainIt = m_Swapchains.find(depth->subImage.swapchain);
-                                        if (depthSwapchainIt == m_Swapchains.end())
-                                        {
-                                            throw std::runtime_error("Swapchain is not registered");
-                                        }
-                                        auto& depthSwapchainState = depthSwapchainIt->second;
-
-                                        depthBuffer = depthSwapchainState.images[depthSwapchainState.acquiredImageIndex]
-                                                          .appTexture;
-                                        nearFar.Near = depth->nearZ;
-                                        nearFar.Far = depth->farZ;
-                                    }
-                                    break;
-                                }
-                                entry = entry->next;
-                            }
-
-                            textureForOverlay[eye] = swapchainImages.runtimeTexture;
-                            sliceForOverlay[eye] = view.subImage.imageArrayIndex;
-                            auto ownDepthBufferIt = m_OwnDepthBuffers.find(swapchainIt->first);
-                            depthForOverlay[eye] = depthBuffer ? depthBuffer
-                                                   : ownDepthBufferIt != m_OwnDepthBuffers.cend()
-                                                       ? ownDepthBufferIt->second
-                                                       : nullptr;
-                            viewForOverlay[eye].Pose = view.pose;
-                            viewForOverlay[eye].Fov = view.fov;
-                            viewForOverlay[eye].NearFar = nearFar;
-                            viewportForOverlay[eye] = view.subImage.imageRect;
-                        }
                     }
                 }
 
-                if (textureForOverlay[0])
+                if (projection)
                 {
-                    const bool useTextureArrays =
-                        textureForOverlay[1] == textureForOverlay[0] && sliceForOverlay[0] != sliceForOverlay[1];
+                    const XrCompositionLayerDepthInfoKHR* depthInfo[graphics::ViewCount]{};
+                    bool targetsValid = m_TargetsValid;
+                    for (uint32_t eye = 0; eye < graphics::ViewCount; eye++)
+                    {
+                        const XrCompositionLayerProjectionView& view = projection->views[eye];
+                        depthInfo[eye] = FindDepthInfo(view);
+                        const OverlayTarget& target = m_Targets[eye];
+                        targetsValid = targetsValid && target.colorSwapchain == view.subImage.swapchain &&
+                                       target.depthSwapchain ==
+                                           (depthInfo[eye] ? depthInfo[eye]->subImage.swapchain : XR_NULL_HANDLE) &&
+                                       target.slice == view.subImage.imageArrayIndex &&
+                                       0 == memcmp(&target.viewport, &view.subImage.imageRect, sizeof(XrRect2Di));
+                    }
+                    if (!targetsValid)
+                    {
+                        UpdateTargets(projection, depthInfo);
+                    }
 
                     // render the tracker pose(s)
                     for (uint32_t eye = 0; eye < graphics::ViewCount; eye++)
                     {
+                        OverlayTarget& target = m_Targets[eye];
+                        const XrCompositionLayerProjectionView& view = projection->views[eye];
+                        const std::shared_ptr<graphics::ITexture>& depthBuffer =
+                            target.depthState
+                                ? target.depthState->images[target.depthState->acquiredImageIndex].appTexture
+                                : target.colorState->ownDepthBuffer;
                         m_GraphicsDevice->setRenderTargets(
                             1,
-                            &textureForOverlay[eye],
-                            useTextureArrays ? reinterpret_cast<int32_t*>(&sliceForOverlay[eye]) : nullptr,
-                            &viewportForOverlay[eye],
-                            depthForOverlay[eye] ,
-                            useTextureArrays ? eye : -1);
-                        m_GraphicsDevice->setViewProjection(viewForOverlay[eye]);
+                            &target.colorState->images[target.colorState->acquiredImageIndex].runtimeTexture,
+                            m_UseTextureArrays ? reinterpret_cast<int32_t*>(&target.slice) : nullptr,
+                            &target.viewport,
+                            depthBuffer,
+                            m_UseTextureArrays ? eye : -1);
+                        m_GraphicsDevice->setViewProjection(
+                            {view.pose,
+                             view.fov,
+                             depthInfo[eye] ? xr::math::NearFar{depthInfo[eye]->nearZ, depthInfo[eye]->farZ}
+                                            : xr::math::NearFar{0.001f, 100.f}});
                         m_GraphicsDevice->clearDepth(1.f);
 
                         XrVector3f scaling{0.02f, 0.02f, 0.02f};
@@ -498,17 +444,16 @@ namespace graphics
             }
 
             // Release the swapchain images now, as we are really done this time.
-            for (auto& swapchain : m_Swapchains)
-            {
-                if (swapchain.second.delayedRelease)
+            m_Swapchains.ForEach([layer](XrSwapchain swapchain, graphics::SwapchainState& swapchainState) {
+                if (swapchainState.delayedRelease)
                 {
-                    TraceLoggingWrite(g_traceProvider, "DelayedSwapchainRelease", TLPArg(swapchain.first, "Swapchain"));
+                    TraceLoggingWrite(g_traceProvider, "DelayedSwapchainRelease", TLPArg(swapchain, "Swapchain"));
 
                     XrSwapchainImageReleaseInfo releaseInfo{XR_TYPE_SWAPCHAIN_IMAGE_RELEASE_INFO};
-                    swapchain.second.delayedRelease = false;
-                    CHECK_XRCMD(layer->OpenXrApi::xrReleaseSwapchainImage(swapchain.first, &releaseInfo));
+                    swapchainState.delayedRelease = false;
+                    CHECK_XRCMD(layer->OpenXrApi::xrReleaseSwapchainImage(swapchain, &releaseInfo));
                 }
-            }
+            });
         }
         else
         {
@@ -516,77 +461,141 @@ namespace graphics
         }
     }
 
-    std::vector<SimpleMeshVertex> Overlay::CreateMarker(bool rgb)
+    const XrCompositionLayerDepthInfoKHR* Overlay::FindDepthInfo(const XrCompositionLayerProjectionView& view)
     {
-        std::vector<SimpleMeshVertex> vertices;
-        vertices = CreateConeMesh({-4.f, 0.f, 0.f},
-                                  {-1.5f, 0.5f, 0.f},
-                                  {0.f, 0.f, 0.f},
-                                  rgb ? DarkRed : DarkMagenta,
-                                  rgb ? Red : Magenta,
-                                  rgb ? LightRed : LightMagenta);
-        std::vector<SimpleMeshVertex> top = CreateConeMesh({0.f, 4.f, 0.f},
-                                                            {0.f, 1.5f, 0.5f},
-                                                            {0.f, 0.f, 0.f},
-                                                            rgb ? DarkBlue : DarkCyan,
-                                                            rgb ? Blue : Cyan,
-                                                            rgb ? LightBlue : LightCyan);
-        vertices.insert(vertices.end(), top.begin(), top.end());
-        std::vector<SimpleMeshVertex> front = CreateConeMesh({0.f, 0.f, 4.f},
-                                                           {0.5f, 0.f, 1.5f},
-                                                           {0.f, 0.f, 0.f},
-                                                           rgb ? DarkGreen : DarkYellow,
-                                                           rgb ? Green : Yellow,
-                                                             rgb ? LightGreen : LightYellow);
-        vertices.insert(vertices.end(), front.begin(), front.end());
-        return vertices;
+        const XrBaseInStructure* entry = reinterpret_cast<const XrBaseInStructure*>(view.next);
+        while (entry)
+        {
+            if (entry->type == XR_TYPE_COMPOSITION_LAYER_DEPTH_INFO_KHR)
+            {
+                const XrCompositionLayerDepthInfoKHR* depth =
+                    reinterpret_cast<const XrCompositionLayerDepthInfoKHR*>(entry);
+                // The order of color/depth textures must match.
+                return depth->subImage.imageArrayIndex == view.subImage.imageArrayIndex ? depth : nullptr;
+            }
+            entry = entry->next;
+        }
+        return nullptr;
     }
 
-    std::vector<SimpleMeshVertex> Overlay::CreateConeMesh(XrVector3f top,
-                                                          XrVector3f side,
-                                                          XrVector3f offset,
-                                                          XrVector3f topColor,
-                                                          XrVector3f sideColor,
-                                                          XrVector3f bottomColor)
+    void Overlay::UpdateTargets(const XrCompositionLayerProjection* projection,
+                                const XrCompositionLayerDepthInfoKHR* const* depthInfo)
     {
-        std::vector<SimpleMeshVertex> vertices;
-        const DirectX::XMVECTOR dxTop = xr::math::LoadXrVector3(top);
-        const DirectX::XMVECTOR dxOffset = xr::math::LoadXrVector3(offset);
-        XrVector3f xrTop;;
-        xr::math::StoreXrVector3(&xrTop, DirectX::XMVectorAdd(dxTop, dxOffset));float angleIncrement = DirectX::XM_2PI / 32.f;
-        xr::math::StoreXrVector3(&xrTop, DirectX::XMVectorAdd(dxTop, dxOffset));angleIncrement = DirectX::XM_2PI / 32.f;
-        DirectX::XMVECTOR rotation = DirectX::XMQuaternionRotationAxis(dxTop, angleIncrement);
-        DirectX::XMVECTOR side1 = xr::math::LoadXrVector3(side);
-        XrVector3f xrSide0, xrSide1;
-        for (int i = 0; i < 32; i++)
+        m_TargetsValid = false;
+        for (uint32_t eye = 0; eye < graphics::ViewCount; eye++)
         {
-            DirectX::XMVECTOR side0 = side1;
-            side1 = DirectX::XMVector3Rotate(side0, rotation);
-            xr::math::StoreXrVector3(&xrSide0, DirectX::XMVectorAdd(side0, dxOffset));
-            xr::math::StoreXrVector3(&xrSide1, DirectX::XMVectorAdd(side1, dxOffset));
-            //xr::math::Pose::Multiply DirectX::XMVECTOR side1 = base;
-  
-            // bottom
-            vertices.push_back({offset, bottomColor});
-            vertices.push_back({xrSide0, sideColor});
-            vertices.push_back({xrSide1, sideColor});
-
-            // top 
-            vertices.push_back({xrTop, topColor});
-            vertices.push_back({xrSide1, sideColor});
-            vertices.push_back({xrSide0, sideColor});
+            const XrCompositionLayerProjectionView& view = projection->views[eye];
+            OverlayTarget& target = m_Targets[eye];
+            target.colorSwapchain = view.subImage.swapchain;
+            target.colorState = m_Swapchains.Find(view.subImage.swapchain);
+            if (!target.colorState)
+            {
+                throw std::runtime_error("Swapchain is not registered");
+            }
+            target.depthSwapchain = XR_NULL_HANDLE;
+            target.depthState = nullptr;
+            if (depthInfo[eye])
+            {
+                DebugLog("Depthbuffer found\n ");
+                TraceLoggingWrite(g_traceProvider,
+                                  "xrEndFrame_View",
+                                  TLArg("Depth", "Type"),
+                                  TLArg(eye, "Index"),
+                                  TLPArg(depthInfo[eye]->subImage.swapchain, "Swapchain"),
+                                  TLArg(depthInfo[eye]->subImage.imageArrayIndex, "ImageArrayIndex"),
+                                  TLXrRect(depthInfo[eye]->subImage.imageRect, "ImageRect"),
+                                  TLArg(depthInfo[eye]->nearZ, "Near"),
+                                  TLArg(depthInfo[eye]->farZ, "Far"),
+                                  TLArg(depthInfo[eye]->minDepth, "MinDepth"),
+                                  TLArg(depthInfo[eye]->maxDepth, "MaxDepth"));
+                target.depthSwapchain = depthInfo[eye]->subImage.swapchain;
+                target.depthState = m_Swapchains.Find(target.depthSwapchain);
+                if (!target.depthState)
+                {
+                    throw std::runtime_error("Swapchain is not registered");
+                }
+            }
+            target.slice = view.subImage.imageArrayIndex;
+            target.viewport = view.subImage.imageRect;
         }
-        return vertices;
+        m_UseTextureArrays =
+            m_Targets[1].colorSwapchain == m_Targets[0].colorSwapchain && m_Targets[0].slice != m_Targets[1].slice;
+        m_TargetsValid = true;
     }
 
-    std::vector<unsigned short> Overlay::CreateIndices(size_t amount)
+    void Overlay::CreateMarker(bool rgb, std::vector<SimpleMeshVertex>& vertices, std::vector<uint16_t>& indices)
     {
-        std::vector<unsigned short> indices;
-        for (unsigned short i = 0; i < amount; i++)
+        vertices.clear();
+        indices.clear();
+        vertices.reserve(3 * (ConeSegments + 2));
+        indices.reserve(3 * ConeSegments * 6);
+        CreateConeMesh({-4.f, 0.f, 0.f},
+                       {-1.5f, 0.5f, 0.f},
+                       {0.f, 0.f, 0.f},
+                       rgb ? DarkRed : DarkMagenta,
+                       rgb ? Red : Magenta,
+                       rgb ? LightRed : LightMagenta,
+                       vertices,
+                       indices);
+        CreateConeMesh({0.f, 4.f, 0.f},
+                       {0.f, 1.5f, 0.5f},
+                       {0.f, 0.f, 0.f},
+                       rgb ? DarkBlue : DarkCyan,
+                       rgb ? Blue : Cyan,
+                       rgb ? LightBlue : LightCyan,
+                       vertices,
+                       indices);
+        CreateConeMesh({0.f, 0.f, 4.f},
+                       {0.5f, 0.f, 1.5f},
+                       {0.f, 0.f, 0.f},
+                       rgb ? DarkGreen : DarkYellow,
+                       rgb ? Green : Yellow,
+                       rgb ? LightGreen : LightYellow,
+                       vertices,
+                       indices);
+    }
+
+    void Overlay::CreateConeMesh(XrVector3f top,
+                                 XrVector3f side,
+                                 XrVector3f offset,
+                                 XrVector3f topColor,
+                                 XrVector3f sideColor,
+                                 XrVector3f bottomColor,
+                                 std::vector<SimpleMeshVertex>& vertices,
+                                 std::vector<uint16_t>& indices)
+    {
+        const DirectX::XMVECTOR dxTop = xr::math::LoadXrVector3(top);
+        const DirectX::XMVECTOR dxOffset = xr::math::LoadXrVector3(offset);
+        const DirectX::XMVECTOR rotation =
+            DirectX::XMQuaternionRotationAxis(dxTop, DirectX::XM_2PI / static_cast<float>(ConeSegments));
+
+        // bottom center and tip are followed by the ring of side vertices shared by bottom and top triangles
+        const auto base = static_cast<uint16_t>(vertices.size());
+        XrVector3f xrTop;
+        xr::math::StoreXrVector3(&xrTop, DirectX::XMVectorAdd(dxTop, dxOffset));
+        vertices.push_back({offset, bottomColor});
+        vertices.push_back({xrTop, topColor});
+
+        DirectX::XMVECTOR dxSide = xr::math::LoadXrVector3(side);
+        XrVector3f xrSide;
+        for (uint16_t i = 0; i < ConeSegments; i++)
         {
-            indices.push_back(i);
+            xr::math::StoreXrVector3(&xrSide, DirectX::XMVectorAdd(dxSide, dxOffset));
+            vertices.push_back({xrSide, sideColor});
+            dxSide = DirectX::XMVector3Rotate(dxSide, rotation);
+        }
+
+        for (uint16_t i = 0; i < ConeSegments; i++)
+        {
+            const auto side0 = static_cast<uint16_t>(base + 2 + i);
+            const auto side1 = static_cast<uint16_t>(base + 2 + (i + 1) % ConeSegments);
+
+            // bottom
+            indices.insert(indices.end(), {base, side0, side1});
+
+            // top
+            indices.insert(indices.end(), {static_cast<uint16_t>(base + 1), side1, side0});
         }
-        return indices;
     }
 
     namespace shader
@@ -23,6 +23,7 @@
 #pragma once
 #include "pch.h"
 #include "interfaces.h"
+#include "utility.h"
 
 namespace graphics
 {
@@ -57,6 +58,8 @@ namespace graphics
         std::vector<SwapchainImages> images;
         uint32_t acquiredImageIndex{0};
         bool delayedRelease{false};
+        // used for the overlay if the application does not submit depth
+        std::shared_ptr<graphics::ITexture> ownDepthBuffer;
     };
 
     class Overlay
@@ -80,22 +83,45 @@ namespace graphics
                          const XrPosef& reversedManipulation,
                          bool mcActivated);
         
+        // indexed mesh of the marker: three cones with shared vertices, in rgb or cmy colors
+        static void CreateMarker(bool rgb, std::vector<SimpleMeshVertex>& vertices, std::vector<uint16_t>& indices);
+
         bool m_Initialized{false};
 
       private:
-        std::vector<SimpleMeshVertex> CreateMarker(bool rgb);
-        std::vector<SimpleMeshVertex> CreateConeMesh(XrVector3f top,
-                                                     XrVector3f side,
-                                                     XrVector3f offset,
-                                                     XrVector3f topColor,
-                                                     XrVector3f sideColor,
-                                                     XrVector3f bottomColor);
-        std::vector<unsigned short> CreateIndices(size_t amount);
+        static constexpr uint16_t ConeSegments{32};
+
+        static void CreateConeMesh(XrVector3f top,
+                                   XrVector3f side,
+                                   XrVector3f offset,
+                                   XrVector3f topColor,
+                                   XrVector3f sideColor,
+                                   XrVector3f bottomColor,
+                                   std::vector<SimpleMeshVertex>& vertices,
+                                   std::vector<uint16_t>& indices);
+
+        // render target setup of one eye, resolved again only if the submitted projection layer changes
+        struct OverlayTarget
+        {
+            XrSwapchain colorSwapchain{XR_NULL_HANDLE};
+            XrSwapchain depthSwapchain{XR_NULL_HANDLE};
+            uint32_t slice{0};
+            XrRect2Di viewport{};
+            SwapchainState* colorState{nullptr};
+            SwapchainState* depthState{nullptr};
+        };
+
+        static const XrCompositionLayerDepthInfoKHR* FindDepthInfo(const XrCompositionLayerProjectionView& view);
+        void UpdateTargets(const XrCompositionLayerProjection* projection,
+                           const XrCompositionLayerDepthInfoKHR* const* depthInfo);
 
         bool m_OverlayActive{false};
         std::shared_ptr<graphics::IDevice> m_GraphicsDevice;
-        std::map<XrSwapchain, graphics::SwapchainState> m_Swapchains;
-        std::unordered_map<XrSwapchain, std::shared_ptr<ITexture>> m_OwnDepthBuffers;
+        utility::HandleTable<XrSwapchain, graphics::SwapchainState> m_Swapchains;
+        // cached targets reference entries of m_Swapchains and need to be invalidated on modification
+        std::array<OverlayTarget, ViewCount> m_Targets{};
+        bool m_TargetsValid{false};
+        bool m_UseTextureArrays{false};
         std::shared_ptr<graphics::ISimpleMesh> m_MeshRGB, m_MeshCMY;
     };
 } // namespace graphics
\ No newline at end of file
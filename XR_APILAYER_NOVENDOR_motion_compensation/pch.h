@@ -25,19 +25,27 @@
 // Standard library.
 #include <algorithm>
 #include <array>
+#include <charconv>
+#include <atomic>
+#include <bitset>
+#include <condition_variable>
 #include <cstdarg>
 #include <ctime>
 #include <iomanip>
 #include <iostream>
 #include <filesystem>
 #include <fstream>
+#include <functional>
 #include <sstream>
 #include <string>
 #include <memory>
 #include <mutex>
+#include <optional>
+#include <thread>
 #include <vector>
 #include <set>
 #include <map>
+#include <unordered_map>
 #define _USE_MATH_DEFINES
 #include <cmath>
 
@@ -0,0 +1,151 @@
+// Copyright(c) 2022 Sebastian Veith
+
+#include "pch.h"
+
+#include "recorder.h"
+#include "config.h"
+#include "layer.h"
+#include "utility.h"
+#include <log.h>
+
+using namespace motion_compensation_layer::log;
+
+namespace Recorder
+{
+    PoseRecorder::~PoseRecorder()
+    {
+        m_Active = false;
+        Close();
+    }
+
+    bool PoseRecorder::Init(const std::string& application)
+    {
+        bool enabled{false};
+        if (!GetConfig()->GetBool(Cfg::RecordPoses, enabled))
+        {
+            return false;
+        }
+        if (enabled && !m_Header)
+        {
+            const std::string fileName(motion_compensation_layer::localAppData.string() + "\\" + application +
+                                       ".trace");
+            if (!Open(fileName))
+            {
+                return false;
+            }
+            Log("recording tracker poses to %s\n", fileName.c_str());
+        }
+        // mapping is kept open until shutdown to avoid invalidating records in progress
+        m_Active = enabled;
+        return true;
+    }
+
+    void PoseRecorder::RecordSample(XrTime time, uint64_t sequence, const void* data, size_t size)
+    {
+        if (!m_Active)
+        {
+            return;
+        }
+        TraceRecord* record = NextRecord();
+        record->type = RecordType::Sample;
+        record->sampleSize = (uint32_t)std::min(size, sizeof(record->sample));
+        record->time = time;
+        record->sequence = sequence;
+        memcpy(record->sample, data, record->sampleSize);
+    }
+
+    void PoseRecorder::RecordPose(XrTime time, const XrPosef& pose, const XrPosef& delta)
+    {
+        if (!m_Active)
+        {
+            return;
+        }
+        TraceRecord* record = NextRecord();
+        record->type = RecordType::Pose;
+        record->sampleSize = 0;
+        record->time = time;
+        record->sequence = 0;
+        record->pose = pose;
+        record->delta = delta;
+    }
+
+    bool PoseRecorder::Open(const std::string& fileName)
+    {
+        constexpr uint64_t fileSize = sizeof(TraceFileHeader) + (uint64_t)TraceCapacity * sizeof(TraceRecord);
+        m_File = CreateFileA(fileName.c_str(),
+                             GENERIC_READ | GENERIC_WRITE,
+                             FILE_SHARE_READ,
+                             nullptr,
+                             CREATE_ALWAYS,
+                             FILE_ATTRIBUTE_NORMAL,
+                             nullptr);
+        if (INVALID_HANDLE_VALUE == m_File)
+        {
+            ErrorLog("%s: unable to create %s: %s\n", __FUNCTION__, fileName.c_str(), utility::LastErrorMsg().c_str());
+            return false;
+        }
+        m_Mapping =
+            CreateFileMappingA(m_File, nullptr, PAGE_READWRITE, (DWORD)(fileSize >> 32), (DWORD)fileSize, nullptr);
+        if (!m_Mapping)
+        {
+            ErrorLog("%s: unable to create file mapping for %s: %s\n",
+                     __FUNCTION__,
+                     fileName.c_str(),
+                     utility::LastErrorMsg().c_str());
+            Close();
+            return false;
+        }
+        void* view = MapViewOfFile(m_Mapping, FILE_MAP_WRITE, 0, 0, 0);
+        if (!view)
+        {
+            ErrorLog("%s: unable to map view of %s: %s\n",
+                     __FUNCTION__,
+                     fileName.c_str(),
+                     utility::LastErrorMsg().c_str());
+            Close();
+            return false;
+        }
+        m_Header = reinterpret_cast<TraceFileHeader*>(view);
+        m_Records = reinterpret_cast<TraceRecord*>(reinterpret_cast<uint8_t*>(view) + sizeof(TraceFileHeader));
+        *m_Header = TraceFileHeader{TraceMagic, TraceVersion, sizeof(TraceRecord), TraceCapacity, 0, {}};
+        return true;
+    }
+
+    void PoseRecorder::Close()
+    {
+        if (m_Header)
+        {
+            UnmapViewOfFile(m_Header);
+        }
+        m_Header = nullptr;
+        m_Records = nullptr;
+        if (m_Mapping)
+        {
+            CloseHandle(m_Mapping);
+        }
+        m_Mapping = nullptr;
+        if (INVALID_HANDLE_VALUE != m_File)
+        {
+            CloseHandle(m_File);
+        }
+        m_File = INVALID_HANDLE_VALUE;
+    }
+
+    TraceRecord* PoseRecorder::NextRecord()
+    {
+        // claim a slot, trackers may be queried from multiple threads
+        const int64_t index = InterlockedIncrement64(&m_Header->count) - 1;
+        return &m_Records[index % TraceCapacity];
+    }
+} // namespace Recorder
+
+std::unique_ptr<Recorder::PoseRecorder> g_Recorder = nullptr;
+
+Recorder::PoseRecorder* GetRecorder()
+{
+    if (!g_Recorder)
+    {
+        g_Recorder = std::make_unique<Recorder::PoseRecorder>();
+    }
+    return g_Recorder.get();
+}
@@ -0,0 +1,68 @@
+// Copyright(c) 2022 Sebastian Veith
+
+#pragma once
+
+#include "pch.h"
+
+namespace Recorder
+{
+    constexpr uint32_t TraceMagic{0x54505843}; // "CXPT"
+    constexpr uint32_t TraceVersion{1};
+    constexpr uint32_t TraceCapacity{65536};
+
+    enum class RecordType : uint32_t
+    {
+        Sample = 0,
+        Pose
+    };
+
+    // binary layout of the trace file, needs to be kept in sync with scripts/decode_pose_trace.py
+    struct TraceFileHeader
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t recordSize;
+        uint32_t capacity;
+        // total number of records written, the latest record is stored at (count - 1) % capacity
+        volatile int64_t count;
+        uint8_t reserved[40];
+    };
+    static_assert(sizeof(TraceFileHeader) == 64);
+
+    struct TraceRecord
+    {
+        RecordType type;
+        uint32_t sampleSize;
+        XrTime time;
+        uint64_t sequence;
+        // filtered tracker pose and resulting delta (RecordType::Pose)
+        XrPosef pose;
+        XrPosef delta;
+        // raw mmf data (RecordType::Sample)
+        uint8_t sample[48];
+    };
+    static_assert(sizeof(TraceRecord) == 128);
+
+    class PoseRecorder
+    {
+      public:
+        ~PoseRecorder();
+        bool Init(const std::string& application);
+        void RecordSample(XrTime time, uint64_t sequence, const void* data, size_t size);
+        void RecordPose(XrTime time, const XrPosef& pose, const XrPosef& delta);
+
+      private:
+        bool Open(const std::string& fileName);
+        void Close();
+        TraceRecord* NextRecord();
+
+        std::atomic_bool m_Active{false};
+        HANDLE m_File{INVALID_HANDLE_VALUE};
+        HANDLE m_Mapping{nullptr};
+        TraceFileHeader* m_Header{nullptr};
+        TraceRecord* m_Records{nullptr};
+    };
+} // namespace Recorder
+
+// Singleton accessor.
+Recorder::PoseRecorder* GetRecorder();
@@ -4,6 +4,8 @@
 
 #include "layer.h"
 #include "feedback.h"
+#include "recorder.h"
+#include "latency.h"
 #include <log.h>
 #include <util.h>
 
@@ -87,8 +89,37 @@ namespace Tracker
         return true;
     }
 
+    bool TrackerBase::ApplyConfig(const std::set<Cfg>& changed)
+    {
+        std::unique_lock lock(m_UpdateMutex);
+        if (changed.contains(Cfg::TransOrder) || changed.contains(Cfg::RotOrder))
+        {
+            // new filters start at the reference pose
+            if (!LoadFilters())
+            {
+                return false;
+            }
+            m_TransFilter->Reset(m_ReferencePose.position);
+            m_RotFilter->Reset(m_ReferencePose.orientation);
+            return true;
+        }
+        float strength;
+        if (changed.contains(Cfg::TransStrength) && GetConfig()->GetFloat(Cfg::TransStrength, strength))
+        {
+            m_TransStrength = m_TransFilter->SetStrength(strength);
+            Log("translational filter strength changed to %f\n", m_TransStrength);
+        }
+        if (changed.contains(Cfg::RotStrength) && GetConfig()->GetFloat(Cfg::RotStrength, strength))
+        {
+            m_RotStrength = m_RotFilter->SetStrength(strength);
+            Log("rotational filter strength changed to %f\n", m_RotStrength);
+        }
+        return true;
+    }
+
     void TrackerBase::ModifyFilterStrength(bool trans, bool increase)
     {
+        std::unique_lock lock(m_UpdateMutex);
         float* currentValue = trans ? &m_TransStrength : &m_RotStrength;
         float prevValue = *currentValue;
         float amount = (1.1f - *currentValue) * 0.05f;
@@ -112,36 +143,50 @@ namespace Tracker
 
     void TrackerBase::SetReferencePose(const XrPosef& pose)
     {
+        std::unique_lock lock(m_UpdateMutex);
         m_TransFilter->Reset(pose.position);
         m_RotFilter->Reset(pose.orientation);
         m_ReferencePose = pose;
         m_Calibrated = true;
-        TraceLoggingWrite(g_traceProvider, "SetReferencePose", TLArg(xr::ToString(pose).c_str(), "ReferencePose"));
+        TraceLoggingWrite(g_traceProvider, "SetReferencePose", TLXrPose(pose, "ReferencePose"));
         Log("tracker reference pose set\n");
     }
 
     void TrackerBase::AdjustReferencePose(const XrPosef& pose)
     {
+        std::unique_lock lock(m_UpdateMutex);
         SetReferencePose(Pose::Multiply(m_ReferencePose, pose));
     }
 
     XrPosef TrackerBase::GetReferencePose(XrSession session, XrTime time)
     {
+        std::unique_lock lock(m_UpdateMutex);
         return m_ReferencePose;
     }
 
-    bool TrackerBase::GetPoseDelta(XrPosef& poseDelta, XrSession session, XrTime time)
+    bool TrackerBase::GetPoseDelta(XrPosef& poseDelta, XrSession session, XrTime time, bool* deferred)
     {
-        // pose already calulated for requested time or unable to calculate
-        if (time == m_LastPoseTime)
+        // pose already calulated for requested time, no synchronization needed
+        if (GetSnapshot(poseDelta, time))
         {
-            // already calulated for requested time;
-            poseDelta = m_LastPoseDelta;
-            TraceLoggingWrite(g_traceProvider,
-                              "GetPoseDelta",
-                              TLArg(xr::ToString(m_LastPoseDelta).c_str(), "LastDelta"));
             return true;
         }
+
+        // only one thread calculates new deltas, others wait and reuse the result
+        std::unique_lock lock(m_UpdateMutex);
+        if (GetSnapshot(poseDelta, time))
+        {
+            return true;
+        }
+        if (deferred)
+        {
+            // checked under lock, mode may have changed since the request was made
+            *deferred = RequiresRuntime();
+            if (*deferred)
+            {
+                return false;
+            }
+        }
         if (m_ResetReferencePose)
         {
             m_ResetReferencePose = !ResetReferencePose(session, time);
@@ -149,24 +194,29 @@ namespace Tracker
         XrPosef curPose{Pose::Identity()};
         if (GetPose(curPose, session, time))
         {
-            // apply translational filter
-            m_TransFilter->Filter(curPose.position);
+            {
+                Latency::Timer timer(Latency::Stage::Filter);
 
-            // apply rotational filter
-            m_RotFilter->Filter(curPose.orientation);
+                // apply translational filter
+                m_TransFilter->Filter(curPose.position);
+
+                // apply rotational filter
+                m_RotFilter->Filter(curPose.orientation);
+            }
 
             TraceLoggingWrite(g_traceProvider,
                               "GetPoseDelta",
-                              TLArg(xr::ToString(curPose).c_str(), "LocationAfterFilter"),
+                              TLXrPose(curPose, "LocationAfterFilter"),
                               TLArg(time, "Time"));
 
             // calculate difference toward reference pose
             poseDelta = Pose::Multiply(Pose::Invert(curPose), m_ReferencePose);
 
-            TraceLoggingWrite(g_traceProvider, "GetPoseDelta", TLArg(xr::ToString(poseDelta).c_str(), "Delta"));
+            TraceLoggingWrite(g_traceProvider, "GetPoseDelta", TLXrPose(poseDelta, "Delta"));
+
+            GetRecorder()->RecordPose(time, curPose, poseDelta);
 
-            m_LastPoseTime = time;
-            m_LastPoseDelta = poseDelta;
+            PublishSnapshot(poseDelta, time);
             return true;
         }
         else
@@ -175,6 +225,47 @@ namespace Tracker
         }
     }
 
+    bool TrackerBase::RequiresRuntime() const
+    {
+        return true;
+    }
+
+    bool TrackerBase::GetSnapshot(XrPosef& poseDelta, XrTime time) const
+    {
+        const PoseSnapshot& snapshot = m_Snapshots[m_SnapshotIndex.load(std::memory_order_acquire)];
+        const uint64_t sequence = snapshot.sequence.load(std::memory_order_acquire);
+        if (0 == sequence || sequence & 1)
+        {
+            // nothing published yet or write in progress
+            return false;
+        }
+        const XrTime snapshotTime = snapshot.time;
+        const XrPosef delta = snapshot.delta;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (sequence != snapshot.sequence.load(std::memory_order_relaxed) || time != snapshotTime)
+        {
+            // slot was overwritten while reading, caller falls back to the locked path
+            return false;
+        }
+        poseDelta = delta;
+        TraceLoggingWrite(g_traceProvider, "GetPoseDelta", TLXrPose(delta, "LastDelta"));
+        return true;
+    }
+
+    void TrackerBase::PublishSnapshot(const XrPosef& poseDelta, XrTime time)
+    {
+        // called with m_UpdateMutex held, so there is only one writer
+        const size_t index = m_SnapshotIndex.load(std::memory_order_relaxed) ^ 1;
+        PoseSnapshot& snapshot = m_Snapshots[index];
+        const uint64_t sequence = snapshot.sequence.load(std::memory_order_relaxed);
+        snapshot.sequence.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        snapshot.time = time;
+        snapshot.delta = poseDelta;
+        snapshot.sequence.store(sequence + 2, std::memory_order_release);
+        m_SnapshotIndex.store(index, std::memory_order_release);
+    }
+
     bool TrackerBase::GetControllerPose(XrPosef& trackerPose, XrSession session, XrTime time)
     {
         if (!m_PhysicalEnabled)
@@ -187,8 +278,9 @@ namespace Tracker
         {
             // Query the latest tracker pose.
             XrSpaceLocation location{XR_TYPE_SPACE_LOCATION, nullptr};
+            if (!layer->IsTrackerActionSynced())
             {
-                // TODO: skip xrSyncActions if other actions are active as well?
+                // sync only if the application didn't include the tracker action set in its sync of this frame
                 XrActiveActionSet activeActionSets;
                 activeActionSets.actionSet = layer->m_ActionSet;
                 activeActionSets.subactionPath = XR_NULL_PATH;
@@ -201,7 +293,7 @@ namespace Tracker
                                   "GetControllerPose",
                                   TLPArg(layer->m_ActionSet, "xrSyncActions"),
                                   TLArg(time, "Time"));
-                CHECK_XRCMD(GetInstance()->xrSyncActions(session, &syncInfo));
+                CHECK_XRCMD(layer->OpenXrApi::xrSyncActions(session, &syncInfo));
             }
             {
                 XrActionStatePose actionStatePose{XR_TYPE_ACTION_STATE_POSE, nullptr};
@@ -238,7 +330,7 @@ namespace Tracker
             }
             TraceLoggingWrite(g_traceProvider,
                               "GetControllerPose",
-                              TLArg(xr::ToString(location.pose).c_str(), "Location"),
+                              TLXrPose(location.pose, "Location"),
                               TLArg(time, "Time"));
             m_ConnectionLost = false;
             trackerPose = location.pose;
@@ -253,6 +345,7 @@ namespace Tracker
 
     bool OpenXrTracker::ResetReferencePose(XrSession session, XrTime time)
     {
+        std::unique_lock lock(m_UpdateMutex);
         XrPosef curPose;
         if (GetPose(curPose, session, time))
         {
@@ -311,10 +404,23 @@ namespace Tracker
         {
             success = false;
         }
+        float check;
+        if (GetConfig()->GetFloat(Cfg::TrackerCheck, check) && check >= 0)
+        {
+            m_Mmf.SetRefreshInterval((XrTime)(check * 1000000000.0));
+            Log("mmf connection refresh interval is set to %.3f ms\n", check * 1000.0);
+        }
+        else
+        {
+            ErrorLog("%s: defaulting to mmf connection refresh interval of %.3f ms\n",
+                     __FUNCTION__,
+                     m_Mmf.GetRefreshInterval() / 1000000.0);
+        }
         if (!TrackerBase::Init())
         {
             success = false;
         }
+        SetRigPoseListener();
         return success;
     }
 
@@ -337,8 +443,42 @@ namespace Tracker
         return success;
     }
 
+    bool VirtualTracker::ApplyConfig(const std::set<Cfg>& changed)
+    {
+        std::unique_lock lock(m_UpdateMutex);
+        bool success = TrackerBase::ApplyConfig(changed);
+        if (changed.contains(Cfg::UseCorPos) && GetConfig()->GetBool(Cfg::UseCorPos, m_LoadPoseFromFile))
+        {
+            Log("center of rotation is %s read from config file\n", m_LoadPoseFromFile ? "" : "not");
+        }
+        float forward, down, right;
+        if ((changed.contains(Cfg::TrackerOffsetForward) || changed.contains(Cfg::TrackerOffsetDown) ||
+             changed.contains(Cfg::TrackerOffsetRight)) &&
+            GetConfig()->GetFloat(Cfg::TrackerOffsetForward, forward) &&
+            GetConfig()->GetFloat(Cfg::TrackerOffsetDown, down) &&
+            GetConfig()->GetFloat(Cfg::TrackerOffsetRight, right))
+        {
+            if (m_Calibrated)
+            {
+                // move current reference pose the same way as manual modification does
+                success = ChangeOffset({m_OffsetRight - right / 100.0f,
+                                        m_OffsetDown - down / 100.0f,
+                                        forward / 100.0f - m_OffsetForward}) &&
+                          success;
+            }
+            else
+            {
+                m_OffsetForward = forward / 100.0f;
+                m_OffsetDown = down / 100.0f;
+                m_OffsetRight = right / 100.0f;
+            }
+        }
+        return success;
+    }
+
     bool VirtualTracker::ResetReferencePose(XrSession session, XrTime time)
     {
+        std::unique_lock lock(m_UpdateMutex);
         bool success = true;
         if (m_LoadPoseFromFile)
         {
@@ -408,6 +548,7 @@ namespace Tracker
 
     bool VirtualTracker::ChangeOffset(XrVector3f modification)
     {
+        std::unique_lock lock(m_UpdateMutex);
         if (m_DebugMode)
         {
             ErrorLog("%s: unable to change offset while cor debug mode is active\n", __FUNCTION__);
@@ -432,12 +573,13 @@ namespace Tracker
         m_ReferencePose = Pose::Multiply(adjustment, m_ReferencePose);
         TraceLoggingWrite(g_traceProvider,
                           "ChangeOffset",
-                          TLArg(xr::ToString(m_ReferencePose).c_str(), "ReferencePose"));
+                          TLXrPose(m_ReferencePose, "ReferencePose"));
         return true;
     }
 
     bool VirtualTracker::ChangeRotation(bool right)
     {
+        std::unique_lock lock(m_UpdateMutex);
         if (m_DebugMode)
         {
             ErrorLog("%s: unable to change offset while cor debug mode is active\n", __FUNCTION__);
@@ -453,6 +595,7 @@ namespace Tracker
 
     void VirtualTracker::SaveReferencePose(XrTime time)
     {
+        std::unique_lock lock(m_UpdateMutex);
         if (m_Calibrated)
         {
             XrSpaceLocation location{XR_TYPE_SPACE_LOCATION, nullptr};
@@ -522,11 +665,11 @@ namespace Tracker
 
             TraceLoggingWrite(g_traceProvider,
                               "LoadReferencePose",
-                              TLArg(xr::ToString(refPose).c_str(), "LoadedPose"));
+                              TLXrPose(refPose, "LoadedPose"));
             refPose = Pose::Multiply(refPose, stageToLocal);   
             TraceLoggingWrite(g_traceProvider,
                               "LoadReferencePose",
-                              TLArg(xr::ToString(refPose).c_str(), "ReferencePose"));
+                              TLXrPose(refPose, "ReferencePose"));
             if (m_DebugMode)
             {
                 // manipulate ref pose orientation to match motion controller
@@ -537,7 +680,7 @@ namespace Tracker
                     refPose.orientation = controllerPose.orientation;
                     TraceLoggingWrite(g_traceProvider,
                                       "LoadReferencePose",
-                                      TLArg(xr::ToString(refPose).c_str(), "DebugPose"));
+                                      TLXrPose(refPose, "DebugPose"));
                 }
             }
             SetReferencePose(refPose);    
@@ -547,6 +690,7 @@ namespace Tracker
 
     bool VirtualTracker::ToggleDebugMode(XrSession session, XrTime time)
     {
+        std::unique_lock lock(m_UpdateMutex);
         bool success = true;
         if (!m_DebugMode)
         {
@@ -584,6 +728,12 @@ namespace Tracker
         return success;
     }
 
+    bool VirtualTracker::RequiresRuntime() const
+    {
+        // cor debug mode and recalibration locate controller or view, the mmf is read without the runtime
+        return m_DebugMode || m_ResetReferencePose;
+    }
+
     bool VirtualTracker::GetPose(XrPosef& trackerPose, XrSession session, XrTime time)
     {
         bool success{true};
@@ -609,8 +759,68 @@ namespace Tracker
         return success;
     }
     
+    void RigPoseHistory::AddSample(const XrPosef& rigPose, const utility::MmfHeader& header)
+    {
+        if (utility::MmfMagic != header.magic)
+        {
+            // legacy mmf layout without timestamp
+            return;
+        }
+        std::unique_lock lock(m_Mutex);
+        if (header.sequence != m_Last.sequence)
+        {
+            m_Prev = m_Last;
+            m_Last = {header.qpcTime, header.sequence, rigPose};
+        }
+    }
+
+    XrPosef RigPoseHistory::Apply(const XrPosef& rigPose, const utility::MmfHeader& header, XrTime time)
+    {
+        if (utility::MmfMagic != header.magic)
+        {
+            // legacy mmf layout without timestamp
+            return rigPose;
+        }
+        // sample may already have been added by the listener thread
+        AddSample(rigPose, header);
+        TimedRigPose last, prev;
+        {
+            std::unique_lock lock(m_Mutex);
+            last = m_Last;
+            prev = m_Prev;
+        }
+
+        // conversion uses a time reference determined on the app thread and doesn't call the runtime
+        XrTime lastTime, prevTime;
+        OpenXrLayer* layer = reinterpret_cast<OpenXrLayer*>(GetInstance());
+        if (!layer || !layer->ConvertToXrTime(last.qpcTime, lastTime))
+        {
+            return rigPose;
+        }
+        if (0 == prev.qpcTime || !layer->ConvertToXrTime(prev.qpcTime, prevTime) || 0 >= lastTime - prevTime)
+        {
+            return last.pose;
+        }
+        const XrTime interval = lastTime - prevTime;
+
+        // interpolate between the two latest samples, extrapolate one sample interval at most
+        const float alpha = std::clamp((float)(time - prevTime) / (float)interval, 0.0f, 2.0f);
+        XrPosef interpolated{Pose::Identity()};
+        interpolated.position = prev.pose.position + alpha * (last.pose.position - prev.pose.position);
+        interpolated.orientation = Quaternion::Slerp(prev.pose.orientation, last.pose.orientation, alpha);
+
+        TraceLoggingWrite(g_traceProvider,
+                          "RigPoseHistory::Apply",
+                          TLArg(last.sequence, "Sequence"),
+                          TLArg(lastTime, "SampleTime"),
+                          TLArg(time, "Time"),
+                          TLArg(alpha, "Alpha"));
+        return interpolated;
+    }
+
     bool YawTracker::ResetReferencePose(XrSession session, XrTime time)
     {
+        std::unique_lock lock(m_UpdateMutex);
         bool useGameEngineValues;
         if (GetConfig()->GetBool(Cfg::UseYawGeOffset, useGameEngineValues) && useGameEngineValues)
         {
@@ -667,12 +877,31 @@ namespace Tracker
 
     bool YawTracker::GetVirtualPose(XrPosef& trackerPose, XrSession session, XrTime time)
     {
-        YawData data{};
+        utility::MmfHeader header{};
         XrPosef rotation{Pose::Identity()};
-        if (!m_Mmf.Read(&data, sizeof(data), time))
+        if (!ReadRigPose(m_Mmf, time, rotation, header))
         {
             return false;
         }
+        trackerPose = Pose::Multiply(m_RigPoseHistory.Apply(rotation, header, time), m_ReferencePose);
+        return true;
+    }
+
+    void YawTracker::SetRigPoseListener()
+    {
+        ListenRigPose(m_Mmf, m_RigPoseHistory);
+    }
+
+    bool YawTracker::ReadRigPose(utility::Mmf& mmf, XrTime time, XrPosef& rigPose, utility::MmfHeader& header)
+    {
+        YawData data{};
+        Latency::Timer timer(Latency::Stage::MmfRead);
+        if (!mmf.Read(&data, sizeof(data), time, &header))
+        {
+            return false;
+        }
+        timer.Stop();
+        GetRecorder()->RecordSample(time, header.sequence, &data, sizeof(data));
 
         DebugLog("YawData:\n\tyaw: %f, pitch: %f, roll: %f\n\tbattery: %f, rotationHeight: %f, "
                  "rotationForwardHead: %f\n\tsixDof: %d, usePos: %d, autoX: %f, autoY: %f\n",
@@ -700,23 +929,58 @@ namespace Tracker
                           TLArg(data.autoX, "AutoX"),
                           TLArg(data.autoY, "AutoY"));
 
-        StoreXrQuaternion(&rotation.orientation,
+        ConvertRigPose(data, rigPose);
+        return true;
+    }
+
+    void YawTracker::ListenRigPose(utility::Mmf& mmf, RigPoseHistory& history)
+    {
+        mmf.SetListener(sizeof(YawData), [&history](const void* data, const utility::MmfHeader& header) {
+            XrPosef rigPose{Pose::Identity()};
+            ConvertRigPose(*reinterpret_cast<const YawData*>(data), rigPose);
+            history.AddSample(rigPose, header);
+        });
+    }
+
+    void YawTracker::ConvertRigPose(const YawData& data, XrPosef& rigPose)
+    {
+        StoreXrQuaternion(&rigPose.orientation,
                           DirectX::XMQuaternionRotationRollPitchYaw(data.pitch * angleToRadian,
                                                                     -data.yaw * angleToRadian,
                                                                     -data.roll * angleToRadian));
+    }
 
-        trackerPose = Pose::Multiply(rotation, m_ReferencePose);
+    bool SixDofTracker::GetVirtualPose(XrPosef& trackerPose, XrSession session, XrTime time)
+    {
+        utility::MmfHeader header{};
+        XrPosef rigPose{Pose::Identity()};
+        if (!ReadRigPose(m_Mmf, m_IsSrs, time, rigPose, header))
+        {
+            return false;
+        }
+        trackerPose = Pose::Multiply(m_RigPoseHistory.Apply(rigPose, header, time), m_ReferencePose);
         return true;
     }
 
-    bool SixDofTracker::GetVirtualPose(XrPosef& trackerPose, XrSession session, XrTime time)
+    void SixDofTracker::SetRigPoseListener()
+    {
+        ListenRigPose(m_Mmf, m_IsSrs, m_RigPoseHistory);
+    }
+
+    bool SixDofTracker::ReadRigPose(utility::Mmf& mmf,
+                                    bool isSrs,
+                                    XrTime time,
+                                    XrPosef& rigPose,
+                                    utility::MmfHeader& header)
     {
         SixDofData data{};
-        XrPosef rigPose{Pose::Identity()};
-        if (!m_Mmf.Read(&data, sizeof(data), time))
+        Latency::Timer timer(Latency::Stage::MmfRead);
+        if (!mmf.Read(&data, sizeof(data), time, &header))
         {
             return false;
         }
+        timer.Stop();
+        GetRecorder()->RecordSample(time, header.sequence, &data, sizeof(data));
 
         DebugLog("MotionData:\n\tyaw: %f, pitch: %f, roll: %f\n\tsway: %f, surge: %f, heave: %f\n",
                  data.yaw,
@@ -735,17 +999,157 @@ namespace Tracker
                           TLArg(data.surge, "Surge"),
                           TLArg(data.heave, "Heave"));
 
+        ConvertRigPose(data, isSrs, rigPose);
+        return true;
+    }
+
+    void SixDofTracker::ListenRigPose(utility::Mmf& mmf, bool isSrs, RigPoseHistory& history)
+    {
+        mmf.SetListener(sizeof(SixDofData), [isSrs, &history](const void* data, const utility::MmfHeader& header) {
+            XrPosef rigPose{Pose::Identity()};
+            ConvertRigPose(*reinterpret_cast<const SixDofData*>(data), isSrs, rigPose);
+            history.AddSample(rigPose, header);
+        });
+    }
+
+    void SixDofTracker::ConvertRigPose(const SixDofData& data, bool isSrs, XrPosef& rigPose)
+    {
         StoreXrQuaternion(&rigPose.orientation,
                           DirectX::XMQuaternionRotationRollPitchYaw((float)data.pitch * -angleToRadian,
                                                                     (float)data.yaw * angleToRadian,
-                                                                    (float)data.roll * (m_IsSrs ? -angleToRadian : angleToRadian)));
+                                                                    (float)data.roll * (isSrs ? -angleToRadian : angleToRadian)));
         rigPose.position =
             XrVector3f{(float)data.sway / -1000.0f, (float)data.heave / 1000.0f, (float)data.surge / 1000.0f};
+    }
+
+    bool CompositeTracker::Init()
+    {
+        bool success = true;
+        std::string rotationFile;
+        if (!GetSource(Cfg::CompositeRotation, m_RotationSource, rotationFile) ||
+            !GetSource(Cfg::CompositeTranslation, m_TranslationSource, m_TranslationFilename))
+        {
+            success = false;
+        }
+        else if (Source::Yaw == m_TranslationSource)
+        {
+            ErrorLog("%s: yaw is not a valid source for translation\n", __FUNCTION__);
+            success = false;
+        }
+        else
+        {
+            m_Filename = rotationFile;
+            Log("composite tracker: rotation from %s, translation from %s\n",
+                m_Filename.c_str(),
+                m_TranslationFilename.c_str());
+        }
+        if (!VirtualTracker::Init())
+        {
+            success = false;
+        }
+        m_TranslationMmf.SetRefreshInterval(m_Mmf.GetRefreshInterval());
+        return success;
+    }
+
+    bool CompositeTracker::LazyInit(XrTime time)
+    {
+        bool success = true;
+        if (!m_SkipLazyInit)
+        {
+            m_TranslationMmf.SetName(m_TranslationFilename);
+            if (!m_TranslationMmf.Open(time))
+            {
+                ErrorLog("unable to open mmf '%s'. Check if motion software is running and motion compensation is "
+                         "activated!\n",
+                         m_TranslationFilename.c_str());
+                success = false;
+            }
+        }
+        if (!VirtualTracker::LazyInit(time))
+        {
+            success = false;
+        }
+        m_SkipLazyInit = success;
+        return success;
+    }
+
+    bool CompositeTracker::GetVirtualPose(XrPosef& trackerPose, XrSession session, XrTime time)
+    {
+        utility::MmfHeader rotationHeader{}, translationHeader{};
+        XrPosef rotationPose{Pose::Identity()}, translationPose{Pose::Identity()};
+        if (!ReadRigPose(m_RotationSource, m_Mmf, time, rotationPose, rotationHeader) ||
+            !ReadRigPose(m_TranslationSource, m_TranslationMmf, time, translationPose, translationHeader))
+        {
+            return false;
+        }
+
+        // align both sources with the requested time before combining them
+        XrPosef rigPose{Pose::Identity()};
+        rigPose.orientation = m_RigPoseHistory.Apply(rotationPose, rotationHeader, time).orientation;
+        rigPose.position = m_TranslationHistory.Apply(translationPose, translationHeader, time).position;
 
         trackerPose = Pose::Multiply(rigPose, m_ReferencePose);
         return true;
     }
 
+    void CompositeTracker::SetRigPoseListener()
+    {
+        ListenRigPose(m_RotationSource, m_Mmf, m_RigPoseHistory);
+        ListenRigPose(m_TranslationSource, m_TranslationMmf, m_TranslationHistory);
+    }
+
+    bool CompositeTracker::GetSource(Cfg key, Source& source, std::string& filename)
+    {
+        std::string type;
+        if (!GetConfig()->GetString(key, type))
+        {
+            return false;
+        }
+        if ("yaw" == type)
+        {
+            source = Source::Yaw;
+            filename = utility::YawMmfName;
+            return true;
+        }
+        if ("srs" == type)
+        {
+            source = Source::Srs;
+            filename = utility::SrsMmfName;
+            return true;
+        }
+        if ("flypt" == type)
+        {
+            source = Source::FlyPt;
+            filename = utility::FlyPtMmfName;
+            return true;
+        }
+        ErrorLog("%s: unknown composite tracker source: %s\n", __FUNCTION__, type.c_str());
+        return false;
+    }
+
+    bool CompositeTracker::ReadRigPose(Source source,
+                                       utility::Mmf& mmf,
+                                       XrTime time,
+                                       XrPosef& rigPose,
+                                       utility::MmfHeader& header)
+    {
+        if (Source::Yaw == source)
+        {
+            return YawTracker::ReadRigPose(mmf, time, rigPose, header);
+        }
+        return SixDofTracker::ReadRigPose(mmf, Source::Srs == source, time, rigPose, header);
+    }
+
+    void CompositeTracker::ListenRigPose(Source source, utility::Mmf& mmf, RigPoseHistory& history)
+    {
+        if (Source::Yaw == source)
+        {
+            YawTracker::ListenRigPose(mmf, history);
+            return;
+        }
+        SixDofTracker::ListenRigPose(mmf, Source::Srs == source, history);
+    }
+
     void GetTracker(TrackerBase** tracker)
     {
         TrackerBase* previousTracker = *tracker;
@@ -782,6 +1186,16 @@ namespace Tracker
                 *tracker = new FlyPtTracker();
                 return;
             }
+            if ("composite" == trackerType)
+            {
+                Log("using combination of memory mapped files as tracker\n");
+                if (previousTracker)
+                {
+                    delete previousTracker;
+                }
+                *tracker = new CompositeTracker();
+                return;
+            }
             if ("controller" == trackerType)
             {
                 Log("using motion controller as tracker\n");
@@ -14,16 +14,17 @@ namespace Tracker
 
         virtual bool Init();
         virtual bool LazyInit(XrTime time);
+        virtual bool ApplyConfig(const std::set<Cfg>& changed);
         void ModifyFilterStrength(bool trans, bool increase);
         virtual bool ResetReferencePose(XrSession session, XrTime time) = 0;
         void AdjustReferencePose(const XrPosef& pose);
         XrPosef GetReferencePose(XrSession session, XrTime time);
-        bool GetPoseDelta(XrPosef& poseDelta, XrSession session, XrTime time);
+        // with deferred set, the calculation is skipped if it requires calls to the runtime (app thread only)
+        bool GetPoseDelta(XrPosef& poseDelta, XrSession session, XrTime time, bool* deferred = nullptr);
+        virtual bool RequiresRuntime() const;
         bool m_SkipLazyInit{false};
         bool m_Calibrated{false};
-        bool m_ResetReferencePose{false};
-       
-        XrPosef m_LastPoseDelta{xr::math::Pose::Identity()};
+        std::atomic_bool m_ResetReferencePose{false};
 
       protected:
         void SetReferencePose(const XrPosef& pose);
@@ -32,13 +33,27 @@ namespace Tracker
 
         XrPosef m_ReferencePose{xr::math::Pose::Identity()};
 
+        // serializes modifications of reference pose, filters and tracker input
+        std::recursive_mutex m_UpdateMutex;
 
       private:
+        // pose delta calculated for a specific time, guarded by a sequence counter (odd = write in progress)
+        struct PoseSnapshot
+        {
+            std::atomic<uint64_t> sequence{0};
+            XrTime time{0};
+            XrPosef delta{xr::math::Pose::Identity()};
+        };
+
         bool LoadFilters();
+        bool GetSnapshot(XrPosef& poseDelta, XrTime time) const;
+        void PublishSnapshot(const XrPosef& poseDelta, XrTime time);
 
         bool m_ConnectionLost{false};
         bool m_PhysicalEnabled{false};
-        XrTime m_LastPoseTime{0};
+        // the slot not referenced by m_SnapshotIndex is written while holding m_UpdateMutex
+        std::array<PoseSnapshot, 2> m_Snapshots{};
+        std::atomic<size_t> m_SnapshotIndex{0};
         float m_TransStrength{0.0f};
         float m_RotStrength{0.0f};
         Filter::FilterBase<XrVector3f>* m_TransFilter = nullptr;
@@ -54,22 +69,47 @@ namespace Tracker
         virtual bool GetPose(XrPosef& trackerPose, XrSession session, XrTime time) override;
     };
 
+    // keeps the latest samples of a timestamped mmf to align them with the requested display time
+    class RigPoseHistory
+    {
+      public:
+        // may be called by the mmf listener thread for each sample signalled by the producer
+        void AddSample(const XrPosef& rigPose, const utility::MmfHeader& header);
+        XrPosef Apply(const XrPosef& rigPose, const utility::MmfHeader& header, XrTime time);
+
+      private:
+        struct TimedRigPose
+        {
+            int64_t qpcTime{0};
+            uint64_t sequence{0};
+            XrPosef pose{xr::math::Pose::Identity()};
+        };
+
+        TimedRigPose m_Last{}, m_Prev{};
+        std::mutex m_Mutex;
+    };
+
     class VirtualTracker : public TrackerBase
     {
       public:
         virtual bool Init() override;
         virtual bool LazyInit(XrTime time) override;
+        virtual bool ApplyConfig(const std::set<Cfg>& changed) override;
         virtual bool ResetReferencePose(XrSession session, XrTime time) override;
         bool ChangeOffset(XrVector3f modification);
         bool ChangeRotation(bool right);
         void SaveReferencePose(XrTime time);
         bool ToggleDebugMode(XrSession session, XrTime time);
+        virtual bool RequiresRuntime() const override;
 
       protected:
         virtual bool GetPose(XrPosef& trackerPose, XrSession session, XrTime time) override;
         virtual bool GetVirtualPose(XrPosef& trackerPose, XrSession session, XrTime time) = 0;
+        virtual void SetRigPoseListener() = 0;
 
         std::string m_Filename;
+        // history is fed by the listener thread of the mmf and has to outlive it
+        RigPoseHistory m_RigPoseHistory;
         utility::Mmf m_Mmf;
         float m_OffsetForward{0.0f}, m_OffsetDown{0.0f}, m_OffsetRight{0.0f};
         
@@ -77,7 +117,8 @@ namespace Tracker
       private:
         bool LoadReferencePose(XrSession session, XrTime time);
 
-        bool m_DebugMode{false}, m_LoadPoseFromFile{false};
+        std::atomic_bool m_DebugMode{false};
+        bool m_LoadPoseFromFile{false};
         XrPosef m_OriginalRefPose{xr::math::Pose::Identity()};
     };
 
@@ -87,12 +128,15 @@ namespace Tracker
       public:
         YawTracker()
         {
-            m_Filename = "Local\\YawVRGEFile";
+            m_Filename = utility::YawMmfName;
         }
         virtual bool ResetReferencePose(XrSession session, XrTime time) override;
+        static bool ReadRigPose(utility::Mmf& mmf, XrTime time, XrPosef& rigPose, utility::MmfHeader& header);
+        static void ListenRigPose(utility::Mmf& mmf, RigPoseHistory& history);
 
       protected:
         virtual bool GetVirtualPose(XrPosef& trackerPose, XrSession session, XrTime time) override;
+        virtual void SetRigPoseListener() override;
 
       private:
         struct YawData
@@ -101,12 +145,20 @@ namespace Tracker
             bool sixDof, usePos;
             float autoX, autoY;
         };
+
+        static void ConvertRigPose(const YawData& data, XrPosef& rigPose);
     };
 
     class SixDofTracker : public VirtualTracker
     {
+      public:
+        static bool
+        ReadRigPose(utility::Mmf& mmf, bool isSrs, XrTime time, XrPosef& rigPose, utility::MmfHeader& header);
+        static void ListenRigPose(utility::Mmf& mmf, bool isSrs, RigPoseHistory& history);
+
       protected:
         virtual bool GetVirtualPose(XrPosef& trackerPose, XrSession session, XrTime time) override;
+        virtual void SetRigPoseListener() override;
        
         bool m_IsSrs{false};
 
@@ -120,6 +172,8 @@ namespace Tracker
             double roll;
             double pitch;
         };
+
+        static void ConvertRigPose(const SixDofData& data, bool isSrs, XrPosef& rigPose);
     };
 
     class FlyPtTracker : public SixDofTracker
@@ -127,7 +181,7 @@ namespace Tracker
       public:
         FlyPtTracker()
         {
-            m_Filename = "Local\\motionRigPose";
+            m_Filename = utility::FlyPtMmfName;
             m_IsSrs = false;
         }
     };
@@ -137,10 +191,40 @@ namespace Tracker
       public:
         SrsTracker()
         {
-            m_Filename = "Local\\SimRacingStudioMotionRigPose";
+            m_Filename = utility::SrsMmfName;
             m_IsSrs = true;
         }
     };
+
+    // combines rotation and translation provided by two different motion software
+    // (all rotational axes from one source, all translational axes from the other)
+    class CompositeTracker : public VirtualTracker
+    {
+      public:
+        virtual bool Init() override;
+        virtual bool LazyInit(XrTime time) override;
+
+      protected:
+        virtual bool GetVirtualPose(XrPosef& trackerPose, XrSession session, XrTime time) override;
+        virtual void SetRigPoseListener() override;
+
+      private:
+        enum class Source
+        {
+            Yaw,
+            Srs,
+            FlyPt
+        };
+
+        bool GetSource(Cfg key, Source& source, std::string& filename);
+        bool ReadRigPose(Source source, utility::Mmf& mmf, XrTime time, XrPosef& rigPose, utility::MmfHeader& header);
+        void ListenRigPose(Source source, utility::Mmf& mmf, RigPoseHistory& history);
+
+        Source m_RotationSource{Source::Yaw}, m_TranslationSource{Source::FlyPt};
+        std::string m_TranslationFilename;
+        RigPoseHistory m_TranslationHistory;
+        utility::Mmf m_TranslationMmf;
+    };
     
     struct ViveTrackerInfo
     {
@@ -6,190 +6,336 @@
 #include <log.h>
 #include <util.h>
 #include "utility.h"
+#include "layer.h"
 
 using namespace motion_compensation_layer::log;
 using namespace xr::math;
 
 namespace utility
 {
-    bool KeyboardInput::Init()
+    std::bitset<256> Win32Input::GetPressedKeys(const std::vector<int>& keys)
     {
-        bool success = true;
-        std::set<Cfg> activities{Cfg::KeyActivate,   Cfg::KeyCenter,        Cfg::KeyTransInc,     Cfg::KeyTransDec,
-                                 Cfg::KeyRotInc,     Cfg::KeyRotDec,        Cfg::KeyOffForward,   Cfg::KeyOffBack,
-                                 Cfg::KeyOffUp,      Cfg::KeyOffDown,       Cfg::KeyOffRight,     Cfg::KeyOffLeft,
-                                 Cfg::KeyRotRight,   Cfg::KeyRotLeft,       Cfg::KeyOverlay,      Cfg::KeyCache,
-                                 Cfg::KeySaveConfig, Cfg::KeySaveConfigApp, Cfg::KeyReloadConfig, Cfg::KeyDebugCor};
-        std::string errors;
-        for (const Cfg& activity : activities)
+        std::bitset<256> pressed;
+        for (const int vk : keys)
         {
-            std::set<int> shortcut;
-            if (GetConfig()->GetShortcut(activity, shortcut))
+            if (GetAsyncKeyState(vk) < 0)
             {
-                m_ShortCuts[activity] = shortcut;
+                pressed.set(vk);
             }
-            else
+        }
+        return pressed;
+    }
+
+    bool ScriptedInput::Load(const std::string& path, std::chrono::steady_clock::time_point start)
+    {
+        std::ifstream file(path);
+        if (!file.is_open())
+        {
+            ErrorLog("%s: unable to open input script %s\n", __FUNCTION__, path.c_str());
+            return false;
+        }
+        m_Steps.clear();
+        m_Current = 0;
+        m_Start = start;
+        bool success{true};
+        std::string line;
+        for (int lineNumber = 1; std::getline(file, line); lineNumber++)
+        {
+            std::istringstream stream(line);
+            long long time;
+            std::string combination;
+            if (line.empty() || ';' == line[0] || !(stream >> time))
             {
+                continue;
+            }
+            stream >> combination;
+            std::set<int> keys;
+            std::string errors;
+            if ("NONE" != combination && !GetConfig()->GetVirtualKeys(combination, keys, errors))
+            {
+                ErrorLog("%s: unknown key(s) in line %d of %s:%s\n",
+                         __FUNCTION__,
+                         lineNumber,
+                         path.c_str(),
+                         errors.c_str());
                 success = false;
+                continue;
+            }
+            Step step{std::chrono::milliseconds(time), {}};
+            for (const int vk : keys)
+            {
+                step.keys.set(vk);
             }
+            m_Steps.push_back(step);
         }
+        std::stable_sort(m_Steps.begin(), m_Steps.end(), [](const Step& a, const Step& b) { return a.time < b.time; });
+        Log("replaying %zu input step(s) from %s\n", m_Steps.size(), path.c_str());
         return success;
     }
 
-    bool KeyboardInput::GetKeyState(Cfg key, bool& isRepeat)
+    std::bitset<256> ScriptedInput::GetPressedKeys(const std::vector<int>& keys)
     {
-        auto it = m_ShortCuts.find(key);
-        if (it == m_ShortCuts.end())
+        const auto elapsed = std::chrono::steady_clock::now() - m_Start;
+        while (m_Current < m_Steps.size() && m_Steps[m_Current].time <= elapsed)
         {
-            ErrorLog("%s(%d): unable to find key\n", __FUNCTION__, key);
-            return false;
+            m_Current++;
         }
-        return UpdateKeyState(it->second, isRepeat);
+        return m_Current ? m_Steps[m_Current - 1].keys : std::bitset<256>();
     }
 
-    bool KeyboardInput::UpdateKeyState(const std::set<int>& vkKeySet, bool& isRepeat)
+    KeyboardInput::~KeyboardInput()
     {
-        const auto isPressed = vkKeySet.size() > 0 && std::all_of(vkKeySet.begin(), vkKeySet.end(), [](int vk) {
-                                   return GetAsyncKeyState(vk) < 0;
-                               });
-        auto keyState = m_KeyStates.find(vkKeySet);
-        const auto now = std::chrono::steady_clock::now();
-        if (m_KeyStates.end() == keyState)
+        StopSampler();
+    }
+
+    bool KeyboardInput::Init()
+    {
+        StopSampler();
+        const bool isReload = m_Start.has_value();
+        if (!isReload)
         {
-            // remember keyState for next call
-            keyState = m_KeyStates.insert({vkKeySet, {false, now}}).first;
+            m_Start = std::chrono::steady_clock::now();
         }
-        const auto lastToggleTime = isPressed != keyState->second.first ? now : keyState->second.second;
-        const auto prevState = std::exchange(keyState->second, {isPressed, lastToggleTime});
-        isRepeat = isPressed && prevState.first && (now - prevState.second) > m_KeyRepeatDelay;
-        if (isRepeat)
+        bool success = true;
+        std::string script;
+        if (GetConfig()->GetString(Cfg::InputScript, script) && !script.empty())
         {
-            // reset toggle time for next repetition
-            keyState->second.second = now;
+            auto scriptedInput = std::make_unique<ScriptedInput>();
+            if (!scriptedInput->Load(motion_compensation_layer::localAppData.string() + "\\" + script, *m_Start))
+            {
+                success = false;
+            }
+            m_Source = std::move(scriptedInput);
         }
-        return isPressed && (!prevState.first || isRepeat);
-    }
-    Mmf::Mmf()
-    {
-        float check;
-        if (GetConfig()->GetFloat(Cfg::TrackerCheck, check) && check >= 0)
+        else
         {
-            m_Check = (XrTime)(check * 1000000000.0);
-            Log("mmf connection refresh interval is set to %.3f ms\n", m_Check / 1000000.0);
+            m_Source = std::make_unique<Win32Input>();
         }
-        else
+        std::bitset<256> usedKeys;
+        for (size_t i = 0; i < ShortcutCount; i++)
+        {
+            m_ShortCuts[i].reset();
+            m_KeyStates[i] = {};
+            const Cfg activity = (Cfg)((size_t)Cfg::KeyActivate + i);
+            std::set<int> shortcut;
+            if (!GetConfig()->GetShortcut(activity, shortcut))
+            {
+                success = false;
+                continue;
+            }
+            for (const int vk : shortcut)
+            {
+                if (0 < vk && vk < 256)
+                {
+                    m_ShortCuts[i].set(vk);
+                }
+                else
+                {
+                    ErrorLog("%s: invalid virtual key number: %d\n", __FUNCTION__, vk);
+                    success = false;
+                }
+            }
+            usedKeys |= m_ShortCuts[i];
+        }
+        m_UsedKeys.clear();
+        for (int vk = 0; vk < 256; vk++)
         {
-            ErrorLog("%s: defaulting to mmf connection refresh interval of %.3f ms\n",
-                     __FUNCTION__,
-                     m_Check / 1000000.0);
+            if (usedKeys.test(vk))
+            {
+                m_UsedKeys.push_back(vk);
+            }
         }
+
+        if (isReload)
+        {
+            // keys held while reloading (e.g. the reload shortcut itself) don't trigger again
+            const std::bitset<256> pressed = m_Source->GetPressedKeys(m_UsedKeys);
+            const auto now = std::chrono::steady_clock::now();
+            for (size_t i = 0; i < ShortcutCount; i++)
+            {
+                const auto& shortcut = m_ShortCuts[i];
+                m_KeyStates[i] = {shortcut.any() && (pressed & shortcut) == shortcut, now};
+            }
+        }
+
+        // discard events of previous configuration
+        m_EventRead = m_EventWrite.load();
+        m_StopSampler = false;
+        m_Sampler = std::thread(&KeyboardInput::Sample, this);
+        return success;
     }
 
-    Mmf::~Mmf()
+    bool KeyboardInput::GetEvent(Cfg& key, bool& isRepeat)
     {
-        Close();
+        const auto now = std::chrono::steady_clock::now();
+        size_t read = m_EventRead.load(std::memory_order_relaxed);
+        while (read != m_EventWrite.load(std::memory_order_acquire))
+        {
+            const KeyEvent event = m_Events[read % EventQueueSize];
+            m_EventRead.store(++read, std::memory_order_release);
+            if (now - event.time > m_EventTimeout)
+            {
+                // don't replay key presses or repetitions from a period without frames
+                DebugLog("KeyboardInput: discarded stale %s of shortcut %u\n",
+                         event.isRepeat ? "repetition" : "press",
+                         event.shortcut);
+                continue;
+            }
+            key = (Cfg)((size_t)Cfg::KeyActivate + event.shortcut);
+            isRepeat = event.isRepeat;
+            return true;
+        }
+        return false;
     }
 
-    void Mmf::SetName(const std::string& name)
+    void KeyboardInput::StopSampler()
     {
-        m_Name = name;
+        if (m_Sampler.joinable())
+        {
+            m_StopSampler = true;
+            m_Sampler.join();
+        }
     }
 
-    bool Mmf::Open(XrTime time)
+    void KeyboardInput::Sample()
     {
-        m_FileHandle = OpenFileMapping(FILE_MAP_READ, FALSE, m_Name.c_str());
-
-        if (m_FileHandle)
+        SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_LOWEST);
+        while (!m_StopSampler)
         {
-            m_View = MapViewOfFile(m_FileHandle, FILE_MAP_READ, 0, 0, 0);
-            if (m_View != NULL)
+            const std::bitset<256> pressed = m_Source->GetPressedKeys(m_UsedKeys);
+            const auto now = std::chrono::steady_clock::now();
+            for (size_t i = 0; i < ShortcutCount; i++)
             {
-                m_LastRefresh = time;
-                m_ConnectionLost = false;
-            }
-            else
-            {
-                DWORD err = GetLastError();
-                ErrorLog("unable to map view of mmf %s: %s\n", m_Name.c_str(), LastErrorMsg().c_str());
-                Close();
-                return false;
+                const auto& shortcut = m_ShortCuts[i];
+                const bool isPressed = shortcut.any() && (pressed & shortcut) == shortcut;
+                KeyState& state = m_KeyStates[i];
+                if (isPressed != std::exchange(state.isPressed, isPressed))
+                {
+                    state.lastToggle = now;
+                    if (isPressed)
+                    {
+                        PushEvent({(uint8_t)i, false, now});
+                    }
+                }
+                else if (isPressed && now - state.lastToggle > m_KeyRepeatDelay)
+                {
+                    // reset toggle time for next repetition
+                    state.lastToggle = now;
+                    PushEvent({(uint8_t)i, true, now});
+                }
             }
+            std::this_thread::sleep_for(m_SampleInterval);
         }
-        else
+    }
+
+    void KeyboardInput::PushEvent(const KeyEvent& event)
+    {
+        const size_t write = m_EventWrite.load(std::memory_order_relaxed);
+        if (write - m_EventRead.load(std::memory_order_acquire) >= EventQueueSize)
         {
-            if (!m_ConnectionLost)
-            {
-                ErrorLog("could not open file mapping object %s: %s", m_Name.c_str(), LastErrorMsg().c_str());
-                m_ConnectionLost = true;
-            }
-            return false;
+            // frame thread is not consuming events (e.g. while loading)
+            return;
         }
-        return true;
+        m_Events[write % EventQueueSize] = event;
+        m_EventWrite.store(write + 1, std::memory_order_release);
+    }
+
+    void FrameArena::Reset()
+    {
+        m_CurrentBlock = 0;
+        m_Offset = 0;
     }
-    bool Mmf::Read(void* buffer, size_t size, XrTime time)
+
+    void* FrameArena::AllocateBytes(size_t size, size_t alignment)
     {
-        if (m_Check > 0 && time - m_LastRefresh > m_Check)
+        while (m_CurrentBlock < m_Blocks.size())
         {
-            Close();
+            Block& block = m_Blocks[m_CurrentBlock];
+            const size_t offset = (m_Offset + alignment - 1) & ~(alignment - 1);
+            if (offset + size <= block.size)
+            {
+                m_Offset = offset + size;
+                return block.memory.get() + offset;
+            }
+            // continue with next block
+            m_CurrentBlock++;
+            m_Offset = 0;
         }
-        if (!m_View)
+        // new memory is only required until the largest frame has been processed once
+        // (start of block is aligned for any fundamental type)
+        const size_t blockSize = std::max(m_BlockSize, size);
+        m_Blocks.push_back({std::make_unique<uint8_t[]>(blockSize), blockSize});
+        m_CurrentBlock = m_Blocks.size() - 1;
+        m_Offset = size;
+        return m_Blocks.back().memory.get();
+    }
+
+    bool IniFile::Load(const std::string& path)
+    {
+        m_Entries.clear();
+        std::ifstream file(path);
+        if (!file.is_open())
         {
-            Open(time);
+            return false;
         }
-        if (m_View)
+        const auto trim = [](const std::string& text) {
+            const size_t first = text.find_first_not_of(" \t\r");
+            return std::string::npos == first ? std::string()
+                                              : text.substr(first, text.find_last_not_of(" \t\r") - first + 1);
+        };
+        std::string line, section;
+        bool firstLine{true};
+        while (std::getline(file, line))
         {
-            try
+            if (firstLine && line.starts_with("\xEF\xBB\xBF"))
             {
-                memcpy(buffer, m_View, size);
+                // skip utf-8 byte order mark
+                line.erase(0, 3);
             }
-            catch (std::exception e)
+            firstLine = false;
+            line = trim(line);
+            if (line.empty() || ';' == line[0])
             {
-                ErrorLog("%s: unable to read from mmf %s: %s\n", __FUNCTION__, m_Name.c_str(), e.what());
-                // reset mmf connection
-                Close();
-                return false;
+                continue;
             }
-            return true;
+            if ('[' == line[0])
+            {
+                const size_t end = line.find(']');
+                section = trim(line.substr(1, std::string::npos == end ? std::string::npos : end - 1));
+                continue;
+            }
+            const size_t separator = line.find('=');
+            if (std::string::npos == separator)
+            {
+                continue;
+            }
+            std::string value = trim(line.substr(separator + 1));
+            if (value.size() > 1 && (('"' == value.front() && '"' == value.back()) ||
+                                     ('\'' == value.front() && '\'' == value.back())))
+            {
+                value = value.substr(1, value.size() - 2);
+            }
+            m_Entries.emplace(MakeIndex(section, trim(line.substr(0, separator))), value);
         }
-        return false;
+        return true;
     }
 
-    void Mmf::Close()
+    bool IniFile::Get(const std::string& section, const std::string& key, std::string& value) const
     {
-        if (m_View)
-        {
-            UnmapViewOfFile(m_View);
-        }
-        m_View = nullptr;
-        if (m_FileHandle)
+        const auto it = m_Entries.find(MakeIndex(section, key));
+        if (m_Entries.end() == it)
         {
-            CloseHandle(m_FileHandle);
+            return false;
         }
-        m_FileHandle = nullptr;
+        value = it->second;
+        return true;
     }
 
-    std::string LastErrorMsg()
+    std::string IniFile::MakeIndex(const std::string& section, const std::string& key)
     {
-        DWORD error = GetLastError();
-        if (error)
-        {
-            LPVOID buffer;
-            DWORD bufLen = FormatMessage(FORMAT_MESSAGE_ALLOCATE_BUFFER | FORMAT_MESSAGE_FROM_SYSTEM |
-                                             FORMAT_MESSAGE_IGNORE_INSERTS,
-                                         NULL,
-                                         error,
-                                         MAKELANGID(LANG_NEUTRAL, SUBLANG_DEFAULT),
-                                         (LPTSTR)&buffer,
-                                         0,
-                                         NULL);
-            if (bufLen)
-            {
-                LPCSTR lpStr = (LPCSTR)buffer;
-                std::string result(lpStr, lpStr + bufLen);
-                LocalFree(buffer);
-                return std::to_string(error) + " - " + result;
-            }
-        }
-        return "0";
+        // line feed can't be part of a section or key name
+        std::string index = section + '\n' + key;
+        std::transform(index.begin(), index.end(), index.begin(), [](unsigned char c) { return (char)tolower(c); });
+        return index;
     }
 } // namespace utility
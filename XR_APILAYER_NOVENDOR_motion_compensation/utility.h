@@ -6,28 +6,104 @@
 
 #include "config.h"
 #include "log.h"
+#include "mmf.h"
 
 namespace utility
 {
+    // provides the state of virtual keys to KeyboardInput
+    class InputSource
+    {
+      public:
+        virtual ~InputSource() = default;
+        virtual std::bitset<256> GetPressedKeys(const std::vector<int>& keys) = 0;
+    };
+
+    class Win32Input : public InputSource
+    {
+      public:
+        std::bitset<256> GetPressedKeys(const std::vector<int>& keys) override;
+    };
+
+    // replays key states from a text file, each line contains the milliseconds since start and the
+    // key combination held from then on (same format as in config file, 'NONE' to release all keys)
+    class ScriptedInput : public InputSource
+    {
+      public:
+        bool Load(const std::string& path, std::chrono::steady_clock::time_point start);
+        std::bitset<256> GetPressedKeys(const std::vector<int>& keys) override;
+
+      private:
+        struct Step
+        {
+            std::chrono::milliseconds time;
+            std::bitset<256> keys;
+        };
+
+        std::vector<Step> m_Steps;
+        size_t m_Current{0};
+        std::chrono::steady_clock::time_point m_Start{};
+    };
+
+    // keyboard is sampled on a separate thread, triggered shortcuts are queued for the frame thread
     class KeyboardInput
     {
       public:
+        ~KeyboardInput();
         bool Init();
-        bool GetKeyState(Cfg key, bool& isRepeat);
+        // returns the next triggered shortcut, only to be called by a single thread
+        // events not consumed in time (e.g. while the app is loading) are discarded
+        bool GetEvent(Cfg& key, bool& isRepeat);
 
       private:
-        bool UpdateKeyState(const std::set<int>& vkKeySet, bool& isRepeat);
+        // shortcuts are defined contiguously from KeyActivate to KeyDebugCor
+        static constexpr size_t ShortcutCount{(size_t)Cfg::KeyDebugCor - (size_t)Cfg::KeyActivate + 1};
+        static constexpr size_t EventQueueSize{64};
 
-        std::map<Cfg, std::set<int>> m_ShortCuts;
-        std::map<std::set<int>, std::pair<bool, std::chrono::steady_clock::time_point>> m_KeyStates;
+        struct KeyEvent
+        {
+            uint8_t shortcut{0};
+            bool isRepeat{false};
+            std::chrono::steady_clock::time_point time{};
+        };
+        struct KeyState
+        {
+            bool isPressed{false};
+            std::chrono::steady_clock::time_point lastToggle{};
+        };
+
+        void StopSampler();
+        void Sample();
+        void PushEvent(const KeyEvent& event);
+
+        std::unique_ptr<InputSource> m_Source;
+        // time of first initialization, kept on reload to continue the timeline of an input script
+        std::optional<std::chrono::steady_clock::time_point> m_Start;
+        std::array<std::bitset<256>, ShortcutCount> m_ShortCuts{};
+        std::vector<int> m_UsedKeys;
+        std::array<KeyState, ShortcutCount> m_KeyStates{};
         const std::chrono::milliseconds m_KeyRepeatDelay = 300ms;
+        const std::chrono::milliseconds m_SampleInterval = 10ms;
+        // shorter than repeat delay to apply at most one repetition per shortcut after a stall
+        const std::chrono::milliseconds m_EventTimeout = 250ms;
+
+        std::thread m_Sampler;
+        std::atomic_bool m_StopSampler{false};
+
+        // single producer / single consumer ring buffer
+        std::array<KeyEvent, EventQueueSize> m_Events{};
+        std::atomic<size_t> m_EventWrite{0};
+        std::atomic<size_t> m_EventRead{0};
     };
 
+    // samples are kept in a sorted vector that retains its capacity, so steady use doesn't allocate
     template <typename Sample>
     class Cache
     {
       public:
-        Cache(Sample fallback) : m_Fallback(fallback){};
+        Cache(Sample fallback) : m_Fallback(fallback)
+        {
+            m_Cache.reserve(InitialCapacity);
+        }
 
         void SetTolerance(XrTime tolerance)
         {
@@ -38,7 +114,12 @@ namespace utility
         {
             std::unique_lock lock(m_Mutex);
 
-            m_Cache.insert({time, sample});
+            // existing sample for the same time is kept
+            auto it = std::lower_bound(m_Cache.begin(), m_Cache.end(), time, IsEarlier);
+            if (m_Cache.end() == it || it->first != time)
+            {
+                m_Cache.insert(it, {time, sample});
+            }
         }
 
         Sample GetSample(XrTime time) const
@@ -49,7 +130,7 @@ namespace utility
 
             LAYER_NAMESPACE::log::DebugLog("GetSample(%s): %u\n", typeid(Sample).name(), time);
 
-            auto it = m_Cache.lower_bound(time);
+            auto it = std::lower_bound(m_Cache.begin(), m_Cache.end(), time, IsEarlier);
             bool itIsEnd = m_Cache.end() == it;
             if (!itIsEnd)
             {
@@ -156,7 +237,7 @@ namespace utility
         {
             std::unique_lock lock(m_Mutex);
 
-            auto it = m_Cache.lower_bound(time - m_Tolerance);
+            auto it = std::lower_bound(m_Cache.begin(), m_Cache.end(), time - m_Tolerance, IsEarlier);
             if (m_Cache.begin() != it)
             {
                 it--;
@@ -168,32 +249,209 @@ namespace utility
         }
 
       private:
-        std::map<XrTime, Sample> m_Cache{};
+        using Entry = std::pair<XrTime, Sample>;
+        static constexpr size_t InitialCapacity{16};
+
+        static bool IsEarlier(const Entry& entry, XrTime time)
+        {
+            return entry.first < time;
+        }
+
+        std::vector<Entry> m_Cache{};
         mutable std::mutex m_Mutex;
         Sample m_Fallback;
         XrTime m_Tolerance{2000000};
     };
 
-    class Mmf
+    // open addressing hash table for openxr handles, entries are stored contiguously to keep per-frame lookups cheap
+    // XR_NULL_HANDLE is used to mark unused slots and cannot be inserted
+    template <typename Handle, typename Value>
+    class HandleTable
+    {
+      public:
+        Value* Find(Handle handle)
+        {
+            const size_t index = FindSlot(handle);
+            return index != NotFound ? &m_Slots[index].value : nullptr;
+        }
+
+        const Value* Find(Handle handle) const
+        {
+            const size_t index = FindSlot(handle);
+            return index != NotFound ? &m_Slots[index].value : nullptr;
+        }
+
+        // inserts or replaces the value stored for the handle
+        Value& Insert(Handle handle, Value value)
+        {
+            if (Value* existing = Find(handle))
+            {
+                *existing = std::move(value);
+                return *existing;
+            }
+            // keep load factor (including removed slots) below 50%
+            if ((m_Count + m_Removed + 1) * 2 > m_Slots.size())
+            {
+                Rehash(std::max<size_t>(16, m_Count * 4));
+            }
+            size_t index = Hash(handle) & (m_Slots.size() - 1);
+            while (SlotState::Used == m_Slots[index].state)
+            {
+                index = (index + 1) & (m_Slots.size() - 1);
+            }
+            if (SlotState::Removed == m_Slots[index].state)
+            {
+                m_Removed--;
+            }
+            m_Slots[index] = {handle, std::move(value), SlotState::Used};
+            m_Count++;
+            return m_Slots[index].value;
+        }
+
+        bool Erase(Handle handle)
+        {
+            const size_t index = FindSlot(handle);
+            if (NotFound == index)
+            {
+                return false;
+            }
+            // leave a marker so probing continues past the slot
+            m_Slots[index] = {XR_NULL_HANDLE, Value{}, SlotState::Removed};
+            m_Count--;
+            m_Removed++;
+            return true;
+        }
+
+        void Clear()
+        {
+            m_Slots.clear();
+            m_Count = 0;
+            m_Removed = 0;
+        }
+
+        size_t Size() const
+        {
+            return m_Count;
+        }
+
+        template <typename Function>
+        void ForEach(Function function)
+        {
+            for (auto& slot : m_Slots)
+            {
+                if (SlotState::Used == slot.state)
+                {
+                    function(slot.handle, slot.value);
+                }
+            }
+        }
+
+      private:
+        enum class SlotState : uint8_t
+        {
+            Free = 0,
+            Used,
+            Removed
+        };
+
+        struct Slot
+        {
+            Handle handle{XR_NULL_HANDLE};
+            Value value{};
+            SlotState state{SlotState::Free};
+        };
+
+        static constexpr size_t NotFound{SIZE_MAX};
+
+        static size_t Hash(Handle handle)
+        {
+            // handles are often pointers or counters, spread them with fibonacci hashing
+            return (size_t)(((uint64_t)handle * 0x9E3779B97F4A7C15ull) >> 32);
+        }
+
+        size_t FindSlot(Handle handle) const
+        {
+            if (m_Slots.empty() || XR_NULL_HANDLE == handle)
+            {
+                return NotFound;
+            }
+            size_t index = Hash(handle) & (m_Slots.size() - 1);
+            while (SlotState::Free != m_Slots[index].state)
+            {
+                if (SlotState::Used == m_Slots[index].state && handle == m_Slots[index].handle)
+                {
+                    return index;
+                }
+                index = (index + 1) & (m_Slots.size() - 1);
+            }
+            return NotFound;
+        }
+
+        void Rehash(size_t capacity)
+        {
+            size_t size = 1;
+            while (size < capacity)
+            {
+                size <<= 1;
+            }
+            std::vector<Slot> slots(size);
+            std::swap(slots, m_Slots);
+            m_Count = 0;
+            m_Removed = 0;
+            for (auto& slot : slots)
+            {
+                if (SlotState::Used == slot.state)
+                {
+                    Insert(slot.handle, std::move(slot.value));
+                }
+            }
+        }
+
+        std::vector<Slot> m_Slots;
+        size_t m_Count{0};
+        size_t m_Removed{0};
+    };
+
+    // bump allocator for data only needed until the end of the current frame, memory is retained between frames
+    class FrameArena
     {
       public:
-        Mmf();
-        ~Mmf();
-        void SetName(const std::string& name);
-        bool Open(XrTime time);
-        bool Read(void* buffer, size_t size, XrTime time);
-        void Close();
-
-
-      private: 
-        XrTime m_Check{1000000000}; // reopen mmf once a second by default
-        XrTime m_LastRefresh{0};
-        std::string m_Name;
-        HANDLE m_FileHandle{nullptr};
-        void* m_View{nullptr};
-        bool m_ConnectionLost{false};
+        // invalidates all previous allocations
+        void Reset();
+
+        template <typename Value>
+        Value* Allocate(size_t count = 1)
+        {
+            static_assert(std::is_trivially_destructible_v<Value>, "arena does not call destructors");
+            return reinterpret_cast<Value*>(AllocateBytes(count * sizeof(Value), alignof(Value)));
+        }
+
+      private:
+        void* AllocateBytes(size_t size, size_t alignment);
+
+        struct Block
+        {
+            std::unique_ptr<uint8_t[]> memory;
+            size_t size{0};
+        };
+        std::vector<Block> m_Blocks;
+        size_t m_CurrentBlock{0};
+        size_t m_Offset{0};
+        const size_t m_BlockSize{16384};
     };
 
-    std::string LastErrorMsg();
+    // read-only ini file, parsed in a single pass into a section/key index
+    // follows GetPrivateProfileString semantics: names are case insensitive, the first occurrence of a key is used,
+    // whitespace and enclosing quotes around values are removed and lines starting with ';' are ignored
+    class IniFile
+    {
+      public:
+        bool Load(const std::string& path);
+        bool Get(const std::string& section, const std::string& key, std::string& value) const;
+
+      private:
+        static std::string MakeIndex(const std::string& section, const std::string& key);
 
+        std::unordered_map<std::string, std::string> m_Entries;
+    };
 } // namespace utility
\ No newline at end of file
@@ -0,0 +1,78 @@
+# Converts the binary pose trace recorded by OpenXR-MotionCompensation (debug/record_poses = 1) into csv.
+# Usage: python decode_pose_trace.py <trace file> <csv file>
+#
+# The layout needs to be kept in sync with XR_APILAYER_NOVENDOR_motion_compensation/recorder.h
+
+import csv
+import struct
+import sys
+
+TRACE_MAGIC = 0x54505843
+TRACE_VERSION = 1
+
+# magic, version, recordSize, capacity, count, reserved
+HEADER = struct.Struct("<IIIIq40x")
+# type, sampleSize, time, sequence, pose (quaternion, position), delta (quaternion, position), sample
+RECORD = struct.Struct("<IIqQ7f7f48s")
+
+RECORD_TYPES = {0: "sample", 1: "pose"}
+
+# raw mmf layouts, identified by their size
+SAMPLE_LAYOUTS = {
+    # YawData: yaw, pitch, roll, battery, rotationHeight, rotationForwardHead, sixDof, usePos, autoX, autoY
+    36: (struct.Struct("<6f??2x2f"), ["yaw", "pitch", "roll", "battery", "rotationHeight", "rotationForwardHead",
+                                      "sixDof", "usePos", "autoX", "autoY"]),
+    # SixDofData: sway, surge, heave, yaw, roll, pitch
+    48: (struct.Struct("<6d"), ["sway", "surge", "heave", "yaw", "roll", "pitch"]),
+}
+SAMPLE_COLUMNS = ["yaw", "pitch", "roll", "sway", "surge", "heave"]
+
+
+def read_records(data):
+    magic, version, record_size, capacity, count = HEADER.unpack_from(data, 0)
+    if magic != TRACE_MAGIC or version != TRACE_VERSION or record_size != RECORD.size:
+        raise ValueError("unsupported trace file: magic = {:#x}, version = {}, record size = {}".format(
+            magic, version, record_size))
+
+    # records are stored in a ring buffer, start with the oldest one
+    first = max(0, count - capacity)
+    for index in range(first, count):
+        offset = HEADER.size + (index % capacity) * record_size
+        yield index, RECORD.unpack_from(data, offset)
+
+
+def decode_sample(size, raw):
+    layout = SAMPLE_LAYOUTS.get(size)
+    if not layout:
+        return {}
+    values = dict(zip(layout[1], layout[0].unpack_from(raw, 0)))
+    return {key: values.get(key, "") for key in SAMPLE_COLUMNS}
+
+
+def main(trace_file, csv_file):
+    with open(trace_file, "rb") as f:
+        data = f.read()
+
+    with open(csv_file, "w", newline="") as f:
+        writer = csv.writer(f)
+        writer.writerow(["index", "type", "time", "sequence",
+                         "pose_qx", "pose_qy", "pose_qz", "pose_qw", "pose_x", "pose_y", "pose_z",
+                         "delta_qx", "delta_qy", "delta_qz", "delta_qw", "delta_x", "delta_y", "delta_z"] +
+                        SAMPLE_COLUMNS + ["raw"])
+        for index, record in read_records(data):
+            record_type, sample_size, time, sequence = record[0:4]
+            pose, delta, raw = record[4:11], record[11:18], record[18][:sample_size]
+            row = [index, RECORD_TYPES.get(record_type, record_type), time, sequence]
+            if record_type == 1:
+                row += list(pose) + list(delta) + [""] * len(SAMPLE_COLUMNS) + [""]
+            else:
+                sample = decode_sample(sample_size, raw)
+                row += [""] * 14 + [sample.get(key, "") for key in SAMPLE_COLUMNS] + [raw.hex()]
+            writer.writerow(row)
+
+
+if __name__ == "__main__":
+    if len(sys.argv) != 3:
+        print("usage: python decode_pose_trace.py <trace file> <csv file>")
+        sys.exit(1)
+    main(sys.argv[1], sys.argv[2])
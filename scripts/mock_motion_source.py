@@ -0,0 +1,97 @@
+# Emulates motion software by writing scripted sine wave motion into the memory mapped file of a virtual tracker.
+# Usage: python mock_motion_source.py <yaw|srs|flypt> [options]
+#
+# Samples are written with the timestamped header (see 'Timestamped tracker data' in the user guide) and the
+# <name>_Event is signalled after each write. Together with debug/record_poses and print_latency_stats.py this allows
+# reproducible end-to-end measurements: the optional csv log contains the ground truth of each sample, which can be
+# compared with the output of decode_pose_trace.py.
+
+import argparse
+import csv
+import ctypes
+import math
+import mmap
+import struct
+import time
+
+MMF_MAGIC = 0x4D43584F
+MMF_VERSION = 1
+# magic, version, sequence, qpcTime
+HEADER = struct.Struct("<IIQq")
+
+SOURCES = {
+    # name, layout, values in layout order (missing values are written as 0)
+    "yaw": ("Local\\YawVRGEFile", struct.Struct("<6f??2x2f"),
+            ["yaw", "pitch", "roll", "battery", "rotationHeight", "rotationForwardHead", "sixDof", "usePos", "autoX",
+             "autoY"]),
+    "srs": ("Local\\SimRacingStudioMotionRigPose", struct.Struct("<6d"),
+            ["sway", "surge", "heave", "yaw", "roll", "pitch"]),
+    "flypt": ("Local\\motionRigPose", struct.Struct("<6d"), ["sway", "surge", "heave", "yaw", "roll", "pitch"]),
+}
+# degrees for rotations, millimeters for translations
+AXES = ["yaw", "pitch", "roll", "sway", "surge", "heave"]
+
+kernel32 = ctypes.windll.kernel32
+
+
+def query_performance_counter():
+    counter = ctypes.c_int64()
+    kernel32.QueryPerformanceCounter(ctypes.byref(counter))
+    return counter.value
+
+
+def motion(elapsed, amplitudes, period):
+    # each axis uses a slightly different phase to avoid perfectly correlated movement
+    return {axis: amplitudes[axis] * math.sin(2.0 * math.pi * elapsed / period + index * math.pi / 6.0)
+            for index, axis in enumerate(AXES)}
+
+
+def main():
+    parser = argparse.ArgumentParser(description="write scripted motion into a virtual tracker mmf")
+    parser.add_argument("source", choices=SOURCES.keys())
+    parser.add_argument("--rate", type=float, default=100.0, help="samples per second")
+    parser.add_argument("--period", type=float, default=4.0, help="period of the sine wave in seconds")
+    parser.add_argument("--duration", type=float, default=0.0, help="seconds to run, 0 = until interrupted")
+    parser.add_argument("--log", help="csv file to log the written samples to")
+    for axis in AXES:
+        parser.add_argument("--" + axis, type=float, default=0.0, help="amplitude of " + axis)
+    args = parser.parse_args()
+
+    name, layout, fields = SOURCES[args.source]
+    amplitudes = {axis: getattr(args, axis) for axis in AXES}
+    view = mmap.mmap(-1, HEADER.size + layout.size, tagname=name)
+    event = kernel32.CreateEventW(None, False, False, name + "_Event")
+    log_file = open(args.log, "w", newline="") if args.log else None
+    writer = csv.writer(log_file) if log_file else None
+    if writer:
+        writer.writerow(["sequence", "qpc_time"] + AXES)
+
+    print("writing to {} at {} Hz, press ctrl+c to stop".format(name, args.rate))
+    sequence, start = 0, time.perf_counter()
+    try:
+        while not args.duration or time.perf_counter() - start < args.duration:
+            values = motion(time.perf_counter() - start, amplitudes, args.period)
+            qpc_time = query_performance_counter()
+            data = layout.pack(*[values.get(field, 0) for field in fields])
+
+            # odd sequence marks a write in progress
+            HEADER.pack_into(view, 0, MMF_MAGIC, MMF_VERSION, sequence + 1, qpc_time)
+            view[HEADER.size:HEADER.size + layout.size] = data
+            sequence += 2
+            HEADER.pack_into(view, 0, MMF_MAGIC, MMF_VERSION, sequence, qpc_time)
+            kernel32.SetEvent(event)
+
+            if writer:
+                writer.writerow([sequence, qpc_time] + [values[axis] for axis in AXES])
+            time.sleep(max(0.0, start + sequence / 2 / args.rate - time.perf_counter()))
+    except KeyboardInterrupt:
+        pass
+    finally:
+        if log_file:
+            log_file.close()
+        kernel32.CloseHandle(event)
+        view.close()
+
+
+if __name__ == "__main__":
+    main()
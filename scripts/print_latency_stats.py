@@ -0,0 +1,86 @@
+# Prints the processing time statistics published by OpenXR-MotionCompensation while an application is running.
+# Usage: python print_latency_stats.py [refresh interval in seconds]
+#
+# The layout needs to be kept in sync with XR_APILAYER_NOVENDOR_motion_compensation/latency.h
+
+import mmap
+import struct
+import sys
+import time
+
+SHARED_MEMORY_NAME = "Local\\OXRMC_LatencyStats"
+STATS_MAGIC = 0x4C435850
+STATS_VERSION = 1
+
+# magic, version, stageCount, bucketCount, subBucketBits, linearBits, qpcFrequency, reserved
+HEADER = struct.Struct("<6Iq32x")
+STAGES = ["xrLocateSpace", "xrLocateViews", "xrEndFrame", "xrSyncActions", "mmf read", "filter", "cache", "overlay"]
+PERCENTILES = [50, 90, 99]
+
+
+def bucket_upper_bound(index, sub_bucket_bits, linear_bits):
+    if index < (1 << linear_bits):
+        return index + 1
+    index -= 1 << linear_bits
+    exponent = index // (1 << sub_bucket_bits) + linear_bits
+    sub_bucket = index % (1 << sub_bucket_bits)
+    return ((1 << sub_bucket_bits) + sub_bucket + 1) << (exponent - sub_bucket_bits)
+
+
+def read_stats():
+    size = HEADER.size
+    with mmap.mmap(-1, size, tagname=SHARED_MEMORY_NAME, access=mmap.ACCESS_READ) as view:
+        magic, version, stage_count, bucket_count, sub_bucket_bits, linear_bits, frequency = HEADER.unpack_from(view, 0)
+    if magic != STATS_MAGIC or version != STATS_VERSION:
+        raise ValueError("no statistics available: magic = {:#x}, version = {}".format(magic, version))
+
+    histogram = struct.Struct("<3q{}q".format(bucket_count))
+    size += stage_count * histogram.size
+    with mmap.mmap(-1, size, tagname=SHARED_MEMORY_NAME, access=mmap.ACCESS_READ) as view:
+        data = view[:size]
+
+    stats = []
+    for stage in range(stage_count):
+        values = histogram.unpack_from(data, HEADER.size + stage * histogram.size)
+        count, total, maximum, buckets = values[0], values[1], values[2], values[3:]
+        percentiles = []
+        for percentile in PERCENTILES:
+            threshold, accumulated = count * percentile / 100.0, 0
+            for index, bucket in enumerate(buckets):
+                accumulated += bucket
+                if accumulated >= threshold:
+                    percentiles.append(bucket_upper_bound(index, sub_bucket_bits, linear_bits))
+                    break
+            else:
+                percentiles.append(maximum)
+        to_us = 1000000.0 / frequency
+        stats.append((STAGES[stage] if stage < len(STAGES) else str(stage),
+                      count,
+                      total / count * to_us if count else 0.0,
+                      [p * to_us for p in percentiles],
+                      maximum * to_us))
+    return stats
+
+
+def print_stats(stats):
+    print("{:<16}{:>12}{:>12}".format("stage", "count", "mean [us]") +
+          "".join("{:>12}".format("p{} [us]".format(p)) for p in PERCENTILES) + "{:>12}".format("max [us]"))
+    for name, count, mean, percentiles, maximum in stats:
+        print("{:<16}{:>12}{:>12.1f}".format(name, count, mean) +
+              "".join("{:>12.1f}".format(p) for p in percentiles) + "{:>12.1f}".format(maximum))
+
+
+def main(interval):
+    while True:
+        print_stats(read_stats())
+        if not interval:
+            break
+        time.sleep(interval)
+        print()
+
+
+if __name__ == "__main__":
+    if len(sys.argv) > 2:
+        print("usage: python print_latency_stats.py [refresh interval in seconds]")
+        sys.exit(1)
+    main(float(sys.argv[1]) if len(sys.argv) == 2 else 0)